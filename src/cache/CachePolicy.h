@@ -0,0 +1,635 @@
+#ifndef CACHE_POLICY_H
+#define CACHE_POLICY_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include "FlatIndex.h"
+
+// Count-Min sketch with 8-bit saturating counters (capped at 15) used to
+// estimate how often a key has been requested recently. Counters are halved
+// every `sample_size` increments so that old popularity fades out.
+class FrequencySketch
+{
+    private:
+        static constexpr int kDepth = 4;
+        static constexpr uint8_t kMaxCount = 15;
+
+        std::vector<uint8_t> table;
+        size_t width_mask;
+        size_t additions;
+        size_t sample_size;
+
+    public:
+        explicit FrequencySketch(size_t expected_entries = 1024)
+        {
+            size_t width = 16;
+            while (width < expected_entries) {
+                width <<= 1;
+            }
+            table.assign(width * kDepth, 0);
+            width_mask = width - 1;
+            additions = 0;
+            sample_size = width * 10;
+        }
+
+        void increment(uint64_t key_hash)
+        {
+            bool added = false;
+            for (int row = 0; row < kDepth; row++) {
+                uint8_t& counter = table[indexOf(key_hash, row)];
+                if (counter < kMaxCount) {
+                    counter++;
+                    added = true;
+                }
+            }
+
+            if (added && ++additions >= sample_size) {
+                reset();
+            }
+        }
+
+        uint32_t frequency(uint64_t key_hash) const
+        {
+            uint32_t freq = kMaxCount;
+            for (int row = 0; row < kDepth; row++) {
+                freq = std::min<uint32_t>(freq, table[indexOf(key_hash, row)]);
+            }
+            return freq;
+        }
+
+        void clear()
+        {
+            std::fill(table.begin(), table.end(), 0);
+            additions = 0;
+        }
+
+    private:
+        size_t indexOf(uint64_t hash, int row) const
+        {
+            // splitmix64 finalizer with a per-row seed
+            uint64_t h = hash + 0x9E3779B97F4A7C15ULL * (row + 1);
+            h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+            h ^= h >> 31;
+            return row * (width_mask + 1) + (h & width_mask);
+        }
+
+        // Aging: halve every counter so the sketch tracks recent popularity
+        void reset()
+        {
+            for (auto& counter : table) {
+                counter >>= 1;
+            }
+            additions /= 2;
+        }
+};
+
+// Per-slot policy state. Policies keep these in one contiguous vector indexed
+// by the cache's slot id and link them by index, so reordering an entry never
+// allocates or chases a heap pointer.
+struct PolicyNode
+{
+    SlotId prev = kNoSlot;
+    SlotId next = kNoSlot;
+    uint64_t key_hash = 0;
+    size_t size_bytes = 0;
+    uint8_t segment = 0;
+};
+
+// Doubly linked list threaded through a PolicyNode vector
+class SlotList
+{
+    private:
+        SlotId head = kNoSlot;
+        SlotId tail = kNoSlot;
+        size_t count = 0;
+
+    public:
+        SlotId front() const { return head; }
+        SlotId back() const { return tail; }
+        bool empty() const { return count == 0; }
+        size_t size() const { return count; }
+
+        void pushFront(std::vector<PolicyNode>& nodes, SlotId slot)
+        {
+            nodes[slot].prev = kNoSlot;
+            nodes[slot].next = head;
+            if (head != kNoSlot) {
+                nodes[head].prev = slot;
+            } else {
+                tail = slot;
+            }
+            head = slot;
+            count++;
+        }
+
+        void remove(std::vector<PolicyNode>& nodes, SlotId slot)
+        {
+            PolicyNode& node = nodes[slot];
+            if (node.prev != kNoSlot) {
+                nodes[node.prev].next = node.next;
+            } else {
+                head = node.next;
+            }
+            if (node.next != kNoSlot) {
+                nodes[node.next].prev = node.prev;
+            } else {
+                tail = node.prev;
+            }
+            node.prev = node.next = kNoSlot;
+            count--;
+        }
+
+        void moveToFront(std::vector<PolicyNode>& nodes, SlotId slot)
+        {
+            if (head != slot) {
+                remove(nodes, slot);
+                pushFront(nodes, slot);
+            }
+        }
+
+        void appendTo(const std::vector<PolicyNode>& nodes, std::vector<SlotId>& out) const
+        {
+            for (SlotId slot = head; slot != kNoSlot; slot = nodes[slot].next) {
+                out.push_back(slot);
+            }
+        }
+
+        void clear()
+        {
+            head = tail = kNoSlot;
+            count = 0;
+        }
+};
+
+// Eviction/admission policy used by LRUFileCache. The cache owns the data and
+// names entries by slot id; the policy only tracks slots, sizes and key
+// hashes and decides what has to go.
+class CachePolicy
+{
+    public:
+        virtual ~CachePolicy() = default;
+
+        virtual const char* name() const = 0;
+
+        // Called on a cache miss so frequency based policies also see misses
+        virtual void recordAccess(uint64_t key_hash) = 0;
+
+        // Called on a cache hit
+        virtual void onHit(SlotId slot) = 0;
+
+        // Track a new slot. Slots the cache must drop are appended to `evicted`;
+        // if `slot` itself is in there the insertion was rejected.
+        virtual void onInsert(SlotId slot, uint64_t key_hash, size_t size_bytes,
+                              std::vector<SlotId>& evicted) = 0;
+
+        // Forget a slot that the cache removed on its own
+        virtual void onRemove(SlotId slot) = 0;
+
+        // Change the byte budget; slots that no longer fit are appended to `evicted`
+        virtual void setCapacity(size_t capacity_bytes, std::vector<SlotId>& evicted) = 0;
+
+        virtual void clear() = 0;
+
+        // Resident slots, most valuable first
+        virtual std::vector<SlotId> slots() const = 0;
+
+        // Popularity estimate, persisted in cache snapshots
+        virtual uint32_t frequency(uint64_t) const { return 0; }
+        virtual void seedFrequency(uint64_t, uint32_t) {}
+
+    protected:
+        static void ensureNode(std::vector<PolicyNode>& nodes, SlotId slot)
+        {
+            if (slot >= nodes.size()) {
+                nodes.resize(std::max<size_t>(slot + 1, nodes.size() * 2));
+            }
+        }
+};
+
+// Classic LRU: every access moves the slot to the front, the back is evicted.
+class LRUPolicy : public CachePolicy
+{
+    private:
+        std::vector<PolicyNode> nodes;
+        SlotList order; // most recent first
+        size_t capacity_bytes;
+        size_t used_bytes;
+
+    public:
+        explicit LRUPolicy(size_t capacity_bytes)
+            : capacity_bytes(capacity_bytes), used_bytes(0) {}
+
+        const char* name() const override { return "LRU"; }
+
+        void recordAccess(uint64_t) override {}
+
+        void onHit(SlotId slot) override
+        {
+            order.moveToFront(nodes, slot);
+        }
+
+        void onInsert(SlotId slot, uint64_t key_hash, size_t size_bytes,
+                      std::vector<SlotId>& evicted) override
+        {
+            ensureNode(nodes, slot);
+            nodes[slot].key_hash = key_hash;
+            nodes[slot].size_bytes = size_bytes;
+            order.pushFront(nodes, slot);
+            used_bytes += size_bytes;
+            evictOverflow(evicted);
+        }
+
+        void onRemove(SlotId slot) override
+        {
+            used_bytes -= nodes[slot].size_bytes;
+            order.remove(nodes, slot);
+        }
+
+        void setCapacity(size_t new_capacity, std::vector<SlotId>& evicted) override
+        {
+            capacity_bytes = new_capacity;
+            evictOverflow(evicted);
+        }
+
+        void clear() override
+        {
+            order.clear();
+            used_bytes = 0;
+        }
+
+        std::vector<SlotId> slots() const override
+        {
+            std::vector<SlotId> result;
+            result.reserve(order.size());
+            order.appendTo(nodes, result);
+            return result;
+        }
+
+    private:
+        void evictOverflow(std::vector<SlotId>& evicted)
+        {
+            while (used_bytes > capacity_bytes && !order.empty()) {
+                SlotId victim = order.back();
+                onRemove(victim);
+                evicted.push_back(victim);
+            }
+        }
+};
+
+// Window TinyLFU (as in Caffeine), made size aware.
+//
+// New keys enter a small LRU window (1% of capacity). Keys pushed out of the
+// window must win an admission contest against the main region victims they
+// would displace: the candidate is admitted only if its estimated frequency is
+// higher than that of every victim. The main region is a segmented LRU
+// (probation + protected) so a single scan over cold files can only churn the
+// window and probation, never the protected hot set.
+class WTinyLFUPolicy : public CachePolicy
+{
+    private:
+        enum Segment : uint8_t { Window, Probation, Protected };
+
+        std::vector<PolicyNode> nodes;
+        SlotList window;    // most recent first
+        SlotList probation;
+        SlotList protected_;
+
+        size_t window_bytes;
+        size_t probation_bytes;
+        size_t protected_bytes;
+
+        size_t window_capacity;
+        size_t main_capacity;
+        size_t protected_capacity;
+
+        FrequencySketch sketch;
+        std::vector<SlotId> victims; // Scratch space reused by admitToMain
+
+    public:
+        // Rough average object size, only used to size the sketch
+        static constexpr size_t kAverageEntryBytes = 16 * 1024;
+
+        explicit WTinyLFUPolicy(size_t capacity_bytes)
+            : window_bytes(0), probation_bytes(0), protected_bytes(0),
+              sketch(std::max<size_t>(capacity_bytes / kAverageEntryBytes, 256))
+        {
+            splitCapacity(capacity_bytes);
+        }
+
+        const char* name() const override { return "W-TinyLFU"; }
+
+        uint32_t frequency(uint64_t key_hash) const override
+        {
+            return sketch.frequency(key_hash);
+        }
+
+        void seedFrequency(uint64_t key_hash, uint32_t freq) override
+        {
+            for (uint32_t i = sketch.frequency(key_hash); i < freq; i++) {
+                sketch.increment(key_hash);
+            }
+        }
+
+        void recordAccess(uint64_t key_hash) override
+        {
+            sketch.increment(key_hash);
+        }
+
+        void onHit(SlotId slot) override
+        {
+            PolicyNode& node = nodes[slot];
+            sketch.increment(node.key_hash);
+
+            switch (node.segment) {
+                case Window:
+                    window.moveToFront(nodes, slot);
+                    break;
+                case Probation:
+                    // Second hit: promote to the protected segment
+                    probation.remove(nodes, slot);
+                    protected_.pushFront(nodes, slot);
+                    probation_bytes -= node.size_bytes;
+                    protected_bytes += node.size_bytes;
+                    node.segment = Protected;
+                    demoteProtectedOverflow();
+                    break;
+                case Protected:
+                    protected_.moveToFront(nodes, slot);
+                    break;
+            }
+        }
+
+        void onInsert(SlotId slot, uint64_t key_hash, size_t size_bytes,
+                      std::vector<SlotId>& evicted) override
+        {
+            ensureNode(nodes, slot);
+            nodes[slot].key_hash = key_hash;
+            nodes[slot].size_bytes = size_bytes;
+            nodes[slot].segment = Window;
+            window.pushFront(nodes, slot);
+            window_bytes += size_bytes;
+
+            while (window_bytes > window_capacity && !window.empty()) {
+                admitToMain(window.back(), evicted);
+            }
+        }
+
+        void onRemove(SlotId slot) override
+        {
+            PolicyNode& node = nodes[slot];
+            listOf(node.segment).remove(nodes, slot);
+            bytesOf(node.segment) -= node.size_bytes;
+        }
+
+        void setCapacity(size_t new_capacity, std::vector<SlotId>& evicted) override
+        {
+            splitCapacity(new_capacity);
+
+            while (window_bytes > window_capacity && !window.empty()) {
+                admitToMain(window.back(), evicted);
+            }
+            demoteProtectedOverflow();
+            while (probation_bytes + protected_bytes > main_capacity) {
+                SlotId victim = !probation.empty() ? probation.back() : protected_.back();
+                onRemove(victim);
+                evicted.push_back(victim);
+            }
+        }
+
+        void clear() override
+        {
+            window.clear();
+            probation.clear();
+            protected_.clear();
+            window_bytes = probation_bytes = protected_bytes = 0;
+            sketch.clear();
+        }
+
+        std::vector<SlotId> slots() const override
+        {
+            std::vector<SlotId> result;
+            result.reserve(window.size() + probation.size() + protected_.size());
+            protected_.appendTo(nodes, result);
+            probation.appendTo(nodes, result);
+            window.appendTo(nodes, result);
+            return result;
+        }
+
+    private:
+        void splitCapacity(size_t capacity_bytes)
+        {
+            window_capacity = capacity_bytes / 100;
+            main_capacity = capacity_bytes - window_capacity;
+            protected_capacity = main_capacity * 8 / 10;
+        }
+
+        SlotList& listOf(uint8_t segment)
+        {
+            switch (segment) {
+                case Window: return window;
+                case Probation: return probation;
+                default: return protected_;
+            }
+        }
+
+        size_t& bytesOf(uint8_t segment)
+        {
+            switch (segment) {
+                case Window: return window_bytes;
+                case Probation: return probation_bytes;
+                default: return protected_bytes;
+            }
+        }
+
+        // Move the window's LRU slot into probation if it beats the victims
+        // it would displace, otherwise evict it.
+        void admitToMain(SlotId candidate, std::vector<SlotId>& evicted)
+        {
+            PolicyNode& node = nodes[candidate];
+            window.remove(nodes, candidate);
+            window_bytes -= node.size_bytes;
+
+            if (node.size_bytes > main_capacity) {
+                evicted.push_back(candidate);
+                return;
+            }
+
+            // Collect victims from the probation tail first, then protected
+            victims.clear();
+            size_t main_bytes = probation_bytes + protected_bytes;
+            size_t freed = 0;
+            for (SlotId slot = probation.back();
+                 slot != kNoSlot && main_bytes - freed + node.size_bytes > main_capacity;
+                 slot = nodes[slot].prev) {
+                victims.push_back(slot);
+                freed += nodes[slot].size_bytes;
+            }
+            for (SlotId slot = protected_.back();
+                 slot != kNoSlot && main_bytes - freed + node.size_bytes > main_capacity;
+                 slot = nodes[slot].prev) {
+                victims.push_back(slot);
+                freed += nodes[slot].size_bytes;
+            }
+
+            uint32_t candidate_freq = sketch.frequency(node.key_hash);
+            for (SlotId victim : victims) {
+                if (sketch.frequency(nodes[victim].key_hash) >= candidate_freq) {
+                    evicted.push_back(candidate);
+                    return;
+                }
+            }
+
+            for (SlotId victim : victims) {
+                onRemove(victim);
+                evicted.push_back(victim);
+            }
+
+            node.segment = Probation;
+            probation.pushFront(nodes, candidate);
+            probation_bytes += node.size_bytes;
+        }
+
+        void demoteProtectedOverflow()
+        {
+            while (protected_bytes > protected_capacity && protected_.size() > 1) {
+                SlotId slot = protected_.back();
+                protected_.remove(nodes, slot);
+                probation.pushFront(nodes, slot);
+                protected_bytes -= nodes[slot].size_bytes;
+                probation_bytes += nodes[slot].size_bytes;
+                nodes[slot].segment = Probation;
+            }
+        }
+};
+
+// CLOCK (second chance): entries carry a reference bit instead of being
+// reordered on every hit. The victim search walks from the oldest entry and
+// gives every referenced entry another round. Because a hit only sets a bit,
+// the bits can live outside the policy and be set by lock-free readers; pass
+// a `reference_source` that tests and clears them.
+class ClockPolicy : public CachePolicy
+{
+    public:
+        using ReferenceSource = std::function<bool(SlotId slot)>;
+
+    private:
+        std::vector<PolicyNode> nodes;
+        std::vector<uint8_t> referenced; // Bits set through onHit
+        SlotList ring; // Newest (or last spared) first; the hand is at the back
+        size_t capacity_bytes;
+        size_t used_bytes;
+        ReferenceSource reference_source;
+
+    public:
+        explicit ClockPolicy(size_t capacity_bytes, ReferenceSource reference_source = nullptr)
+            : capacity_bytes(capacity_bytes), used_bytes(0),
+              reference_source(std::move(reference_source)) {}
+
+        const char* name() const override { return "CLOCK"; }
+
+        void recordAccess(uint64_t) override {}
+
+        void onHit(SlotId slot) override
+        {
+            referenced[slot] = 1;
+        }
+
+        void onInsert(SlotId slot, uint64_t key_hash, size_t size_bytes,
+                      std::vector<SlotId>& evicted) override
+        {
+            ensureNode(nodes, slot);
+            if (slot >= referenced.size()) {
+                referenced.resize(nodes.size(), 0);
+            }
+            nodes[slot].key_hash = key_hash;
+            nodes[slot].size_bytes = size_bytes;
+            referenced[slot] = 0;
+            ring.pushFront(nodes, slot);
+            used_bytes += size_bytes;
+            evictOverflow(evicted);
+        }
+
+        void onRemove(SlotId slot) override
+        {
+            used_bytes -= nodes[slot].size_bytes;
+            ring.remove(nodes, slot);
+        }
+
+        void setCapacity(size_t new_capacity, std::vector<SlotId>& evicted) override
+        {
+            capacity_bytes = new_capacity;
+            evictOverflow(evicted);
+        }
+
+        void clear() override
+        {
+            ring.clear();
+            used_bytes = 0;
+        }
+
+        std::vector<SlotId> slots() const override
+        {
+            std::vector<SlotId> result;
+            result.reserve(ring.size());
+            ring.appendTo(nodes, result);
+            return result;
+        }
+
+    private:
+        bool testAndClear(SlotId slot)
+        {
+            bool bit = referenced[slot] != 0;
+            referenced[slot] = 0;
+            if (reference_source && reference_source(slot)) {
+                bit = true;
+            }
+            return bit;
+        }
+
+        void evictOverflow(std::vector<SlotId>& evicted)
+        {
+            // With a reference source (the RCU backend) readers can set bits
+            // again while the hand sweeps, so a second chance is not enough
+            // to terminate: after two full revolutions without a victim the
+            // entry under the hand goes regardless
+            size_t spared = 0;
+            while (used_bytes > capacity_bytes && !ring.empty()) {
+                SlotId hand = ring.back();
+                if (spared < 2 * ring.size() && testAndClear(hand) && ring.size() > 1) {
+                    ring.moveToFront(nodes, hand);
+                    spared++;
+                    continue;
+                }
+                onRemove(hand);
+                evicted.push_back(hand);
+                spared = 0;
+            }
+        }
+};
+
+enum class CachePolicyType
+{
+    LRU,
+    WTinyLFU,
+    Clock
+};
+
+inline std::unique_ptr<CachePolicy> makeCachePolicy(CachePolicyType type, size_t capacity_bytes)
+{
+    switch (type) {
+        case CachePolicyType::LRU:
+            return std::make_unique<LRUPolicy>(capacity_bytes);
+        case CachePolicyType::Clock:
+            return std::make_unique<ClockPolicy>(capacity_bytes);
+        case CachePolicyType::WTinyLFU:
+        default:
+            return std::make_unique<WTinyLFUPolicy>(capacity_bytes);
+    }
+}
+
+#endif // CACHE_POLICY_H
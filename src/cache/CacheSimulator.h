@@ -0,0 +1,153 @@
+#ifndef CACHE_SIMULATOR_H
+#define CACHE_SIMULATOR_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <istream>
+#include <sstream>
+#include "CachePolicy.h"
+
+// One request in an access trace
+struct TraceRecord
+{
+    std::string key;
+    size_t size_bytes;
+};
+
+struct SimulationResult
+{
+    std::string policy;
+    size_t capacity_bytes = 0;
+    size_t max_file_bytes = 0;
+    size_t requests = 0;
+    size_t hits = 0;
+    size_t bytes_requested = 0;
+    size_t bytes_hit = 0;
+
+    double hitRatio() const {
+        return requests ? static_cast<double>(hits) / requests : 0.0;
+    }
+
+    double byteHitRatio() const {
+        return bytes_requested ? static_cast<double>(bytes_hit) / bytes_requested : 0.0;
+    }
+};
+
+// Bytes an entry counts against the capacity; by default just its size
+using ChargeFunction = std::function<size_t(const TraceRecord& record)>;
+
+// Replays a trace through a cache policy the same way LRUFileCache drives it
+// (lookup, then insert on miss), without storing any file content.
+inline SimulationResult simulateTrace(CachePolicyType type, size_t capacity_bytes,
+                                      size_t max_file_bytes, const std::vector<TraceRecord>& trace,
+                                      const ChargeFunction& charge = nullptr)
+{
+    auto policy = makeCachePolicy(type, capacity_bytes);
+
+    SimulationResult result;
+    result.policy = policy->name();
+    result.capacity_bytes = capacity_bytes;
+    result.max_file_bytes = max_file_bytes;
+
+    // Every distinct key gets a fixed slot id, residency is tracked per slot
+    std::hash<std::string> hasher;
+    std::unordered_map<std::string, SlotId> slot_of;
+    std::vector<bool> resident;
+    std::vector<SlotId> evicted;
+
+    for (const auto& record : trace) {
+        result.requests++;
+        result.bytes_requested += record.size_bytes;
+
+        auto found = slot_of.emplace(record.key, static_cast<SlotId>(slot_of.size()));
+        SlotId slot = found.first->second;
+        if (found.second) {
+            resident.push_back(false);
+        }
+
+        if (resident[slot]) {
+            result.hits++;
+            result.bytes_hit += record.size_bytes;
+            policy->onHit(slot);
+            continue;
+        }
+
+        uint64_t key_hash = hasher(record.key);
+        policy->recordAccess(key_hash);
+        if (record.size_bytes > max_file_bytes) {
+            continue;
+        }
+
+        evicted.clear();
+        policy->onInsert(slot, key_hash, charge ? charge(record) : record.size_bytes, evicted);
+        resident[slot] = true;
+        for (SlotId victim : evicted) {
+            resident[victim] = false;
+        }
+    }
+
+    return result;
+}
+
+// Parse one access log line into a record. Accepts either "<path> <bytes>"
+// or Common/Combined Log Format, where only successful GETs with a byte
+// count are kept. Query strings are stripped, as the file cache keys by path.
+inline bool parseTraceLine(const std::string& line, TraceRecord& record)
+{
+    std::string path;
+    std::string bytes;
+
+    size_t request_start = line.find('"');
+    if (request_start == std::string::npos) {
+        std::istringstream fields(line);
+        if (!(fields >> path >> bytes) || path[0] == '#') {
+            return false;
+        }
+    } else {
+        // ... "GET /path HTTP/1.1" 200 1234 ...
+        size_t request_end = line.find('"', request_start + 1);
+        if (request_end == std::string::npos) {
+            return false;
+        }
+        std::istringstream request(line.substr(request_start + 1, request_end - request_start - 1));
+        std::string method;
+        std::istringstream status_fields(line.substr(request_end + 1));
+        std::string status;
+        if (!(request >> method >> path) || method != "GET" ||
+            !(status_fields >> status >> bytes) || status != "200") {
+            return false;
+        }
+    }
+
+    size_t query = path.find('?');
+    if (query != std::string::npos) {
+        path.resize(query);
+    }
+    if (path.empty() || bytes.empty() || bytes.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+
+    record.key = std::move(path);
+    record.size_bytes = std::stoull(bytes);
+    return true;
+}
+
+// Read every parsable line of an access log; `skipped` counts the others
+inline std::vector<TraceRecord> loadTrace(std::istream& in, size_t* skipped = nullptr)
+{
+    std::vector<TraceRecord> trace;
+    std::string line;
+    TraceRecord record;
+    while (std::getline(in, line)) {
+        if (parseTraceLine(line, record)) {
+            trace.push_back(record);
+        } else if (skipped && !line.empty()) {
+            (*skipped)++;
+        }
+    }
+    return trace;
+}
+
+#endif // CACHE_SIMULATOR_H
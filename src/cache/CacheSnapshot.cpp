@@ -0,0 +1,167 @@
+#include "CacheSnapshot.h"
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <cstdio>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+constexpr char CacheSnapshot::kMagic[8];
+
+CacheSnapshot::Result CacheSnapshot::save(const LRUFileCache& cache, const std::string& path) {
+    auto start_time = std::chrono::steady_clock::now();
+    Result result;
+
+    auto entries = cache.exportEntries();
+    std::string tmp_path = path + ".tmp";
+    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        std::cerr << "[CacheSnapshot] Cannot write " << tmp_path << std::endl;
+        return result;
+    }
+
+    FileHeader header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.entry_count = static_cast<uint32_t>(entries.size());
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    for (const auto& entry : entries) {
+        const CachedFile& file = *entry.file;
+
+        RecordHeader record{};
+        record.key_length = static_cast<uint32_t>(entry.key.size());
+        record.mime_length = static_cast<uint32_t>(file.mime_type.size());
+        record.etag_length = static_cast<uint32_t>(file.etag.size());
+        record.flags = entry.pinned ? 1u : 0u;
+        record.frequency = entry.frequency;
+        record.content_length = file.content.size();
+
+        out.write(reinterpret_cast<const char*>(&record), sizeof(record));
+        out.write(entry.key.data(), entry.key.size());
+        out.write(file.mime_type.data(), file.mime_type.size());
+        out.write(file.etag.data(), file.etag.size());
+        out << file.content;
+
+        result.bytes += file.content.size();
+    }
+
+    out.close();
+    if (!out || std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::cerr << "[CacheSnapshot] Failed to write snapshot " << path << std::endl;
+        std::remove(tmp_path.c_str());
+        return result;
+    }
+
+    result.ok = true;
+    result.entries = entries.size();
+    result.elapsed_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start_time).count();
+
+    std::cout << "[CacheSnapshot] Saved " << result.entries << " entries ("
+              << (result.bytes / 1024) << "KB) to " << path << " in "
+              << result.elapsed_ms << " ms" << std::endl;
+    return result;
+}
+
+CacheSnapshot::Result CacheSnapshot::load(LRUFileCache& cache, const std::string& path) {
+    auto start_time = std::chrono::steady_clock::now();
+    Result result;
+
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cout << "[CacheSnapshot] No snapshot at " << path << std::endl;
+        return result;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(FileHeader)) {
+        close(fd);
+        std::cerr << "[CacheSnapshot] Snapshot too small: " << path << std::endl;
+        return result;
+    }
+
+    size_t length = static_cast<size_t>(st.st_size);
+    void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "[CacheSnapshot] mmap() failed: " << strerror(errno) << std::endl;
+        return result;
+    }
+    madvise(mapping, length, MADV_SEQUENTIAL);
+
+    const char* data = static_cast<const char*>(mapping);
+    const char* end = data + length;
+
+    FileHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion) {
+        std::cerr << "[CacheSnapshot] Unrecognized snapshot format: " << path << std::endl;
+        munmap(mapping, length);
+        return result;
+    }
+
+    // Every record takes at least its header, so a larger count is corrupt
+    // and must not size the reservation below
+    const char* cursor = data + sizeof(header);
+    if (header.entry_count > static_cast<size_t>(end - cursor) / sizeof(RecordHeader)) {
+        std::cerr << "[CacheSnapshot] Entry count " << header.entry_count
+                  << " does not fit in " << path << std::endl;
+        munmap(mapping, length);
+        return result;
+    }
+
+    // Parse everything first, then insert lowest priority first
+    std::vector<LRUFileCache::SnapshotEntry> entries;
+    entries.reserve(header.entry_count);
+    for (uint32_t i = 0; i < header.entry_count; i++) {
+        RecordHeader record;
+        if (static_cast<size_t>(end - cursor) < sizeof(record)) {
+            break;
+        }
+        std::memcpy(&record, cursor, sizeof(record));
+        cursor += sizeof(record);
+
+        uint64_t payload = static_cast<uint64_t>(record.key_length) + record.mime_length +
+                           record.etag_length + record.content_length;
+        if (payload > static_cast<uint64_t>(end - cursor)) {
+            std::cerr << "[CacheSnapshot] Truncated record " << i << " in " << path << std::endl;
+            break;
+        }
+
+        std::string key(cursor, record.key_length);
+        cursor += record.key_length;
+        std::string mime_type(cursor, record.mime_length);
+        cursor += record.mime_length;
+        std::string etag(cursor, record.etag_length);
+        cursor += record.etag_length;
+        // Copied straight from the mapping into slab storage
+        auto file = std::make_shared<const CachedFile>(
+            std::string_view(cursor, record.content_length), mime_type, etag);
+        cursor += record.content_length;
+
+        entries.push_back({key, std::move(file), (record.flags & 1u) != 0, record.frequency});
+    }
+
+    munmap(mapping, length);
+
+    for (auto it = entries.rbegin(); it != entries.rend(); ++it) {
+        if (cache.restore(*it)) {
+            result.entries++;
+            result.bytes += it->file->size_bytes;
+        }
+    }
+
+    result.ok = true;
+    result.elapsed_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start_time).count();
+
+    std::cout << "[CacheSnapshot] Restored " << result.entries << "/" << entries.size()
+              << " entries (" << (result.bytes / 1024) << "KB) from " << path << " in "
+              << result.elapsed_ms << " ms" << std::endl;
+    return result;
+}
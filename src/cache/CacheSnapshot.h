@@ -0,0 +1,58 @@
+#ifndef CACHE_SNAPSHOT_H
+#define CACHE_SNAPSHOT_H
+
+#include <string>
+#include <cstdint>
+#include "FileCache.h"
+
+// Persists the file cache across restarts.
+//
+// File layout (native byte order, written to <path>.tmp then renamed):
+//   header : magic "WSCSNAP1", uint32 version, uint32 entry count
+//   record : RecordHeader, then key, mime type, etag and content bytes
+// Records are stored in cache priority order (pinned first, then the policy's
+// most valuable entries) together with their frequency estimate, and are
+// re-inserted in reverse so the restored cache keeps the same ordering.
+class CacheSnapshot
+{
+    public:
+        struct Result
+        {
+            bool ok = false;
+            size_t entries = 0;
+            size_t bytes = 0;
+            double elapsed_ms = 0;
+        };
+
+        static Result save(const LRUFileCache& cache, const std::string& path);
+
+        // Maps the snapshot with mmap and restores every record that still
+        // fits; restored entries are validated on their first hit. Loading is
+        // eager: contents are copied into slab storage and the mapping is
+        // released before returning.
+        static Result load(LRUFileCache& cache, const std::string& path);
+
+    private:
+        static constexpr char kMagic[8] = {'W', 'S', 'C', 'S', 'N', 'A', 'P', '1'};
+        static constexpr uint32_t kVersion = 1;
+
+        struct FileHeader
+        {
+            char magic[8];
+            uint32_t version;
+            uint32_t entry_count;
+        };
+
+        struct RecordHeader
+        {
+            uint32_t key_length;
+            uint32_t mime_length;
+            uint32_t etag_length;
+            uint32_t flags;      // bit 0: pinned
+            uint32_t frequency;
+            uint32_t reserved;
+            uint64_t content_length;
+        };
+};
+
+#endif // CACHE_SNAPSHOT_H
@@ -8,131 +8,547 @@
 #include <chrono>
 #include <iostream>
 #include <mutex>
+#include <vector>
+#include <functional>
+#include <future>
+#include <atomic>
+#include <string_view>
+#include <cstring>
+#include "CachePolicy.h"
+#include "FlatIndex.h"
+#include "SlabAllocator.h"
+#include "SegmentedBuffer.h"
+#include "RcuFileIndex.h"
+#include "StripedCounter.h"
 
+// A cached response body. The bytes live in a chain of SlabAllocator
+// blocks (`content`), so even the largest files need no contiguous buffer
+// and responses can send the segments in place.
 struct CachedFile
 {
-    std::string content;
+    SegmentedBuffer content;
     std::string mime_type;
+    std::string etag;   // Validator of the file version this content came from
     size_t size_bytes;
-    std::chrono::system_clock::time_point cached_time;
+    size_t memory_bytes; // Slab blocks plus this object and its strings
 
-    CachedFile(const std::string& content, const std::string& mime_type)
-        : content(content), mime_type(mime_type),
-          size_bytes(content.size()), cached_time(std::chrono::system_clock::now()) {}
+    // When the content was loaded or last confirmed to match the file.
+    // Revalidation refreshes it in place, readers compare it against a TTL.
+    mutable std::atomic<std::chrono::system_clock::time_point> cached_time;
+
+    CachedFile(std::string_view body, const std::string& mime_type, const std::string& etag = "")
+        : CachedFile(SegmentedBuffer(body), mime_type, etag) {}
+
+    // Takes over a body that was filled incrementally (e.g. read from disk)
+    CachedFile(SegmentedBuffer body, const std::string& mime_type, const std::string& etag = "")
+        : content(std::move(body)), mime_type(mime_type), etag(etag), size_bytes(content.size()),
+          cached_time(std::chrono::system_clock::now())
+    {
+        memory_bytes = content.memoryBytes() + sizeof(CachedFile) +
+                       kSharedControlBytes + this->mime_type.size() + this->etag.size();
+    }
+
+    CachedFile(const CachedFile& other)
+        : CachedFile(SegmentedBuffer(other.content), other.mime_type, other.etag) {}
+
+    CachedFile& operator=(const CachedFile&) = delete;
+
+    std::chrono::system_clock::duration age(std::chrono::system_clock::time_point now) const
+    {
+        return now - cached_time.load(std::memory_order_relaxed);
+    }
+
+    void markFresh() const
+    {
+        cached_time.store(std::chrono::system_clock::now(), std::memory_order_relaxed);
+    }
+
+    // Reference counts of the shared_ptr that owns a cached file
+    static constexpr size_t kSharedControlBytes = 16;
 };
 
-// Double Linked List Node for LRU Cache
-struct CacheNode
+// How readers reach the cache. Locked serializes every lookup on the cache
+// mutex; RCU mirrors the index into an RcuFileIndex so hits take no lock and
+// drives eviction with CLOCK reference bits set by those readers.
+enum class CacheBackend
 {
-    std::string key; // filea Path
-    CachedFile file;
-    std::shared_ptr<CacheNode> prev;
-    std::shared_ptr<CacheNode> next;
-
-    CacheNode(const std::string& key, const CachedFile& data)
-        : key(key), file(data), prev(nullptr), next(nullptr) {}
+    Locked,
+    RCU
 };
 
 class LRUFileCache
 {
     private:
-        std::unordered_map<std::string, std::shared_ptr<CacheNode>> cache_map;
+        struct CacheEntry
+        {
+            std::string key;
+            std::shared_ptr<const CachedFile> file; // Shared with readers, never copied
+            uint64_t hash = 0;
+            size_t charge = 0; // Bytes counted against the budget
+            bool pinned = false; // Pinned entries are invisible to the policy and never evicted
+            bool validated = true; // False for entries restored from a snapshot until first checked
+            bool in_use = false;
+        };
+
+        // Entries live in one contiguous slot array; the slot id is also the
+        // handle the policy links by. `index` maps key hashes to slots.
+        std::vector<CacheEntry> entries;
+        std::vector<SlotId> free_slots;
+        FlatIndex index;
+
+        // Decides which entries are admitted and which get evicted
+        std::unique_ptr<CachePolicy> policy;
 
-        std::shared_ptr<CacheNode> head;
-        std::shared_ptr<CacheNode> tail;
+        // Lock-free mirror of `index` for readers, RCU backend only
+        std::unique_ptr<RcuFileIndex> rcu;
 
-        size_t capacity_bytes;
-        size_t current_size_bytes;
+        // Gauges are only written under cache_mutex but are atomic so that
+        // getStats() can read them without taking the lock
+        std::atomic<size_t> entry_count;
+        std::atomic<size_t> capacity_bytes;      // Budget for memory_bytes, metadata included
+        std::atomic<size_t> current_size_bytes;  // Body bytes
+        std::atomic<size_t> current_memory_bytes; // Everything charged against the budget
+        std::atomic<size_t> pinned_bytes;
+        size_t pinned_memory_bytes;
         size_t max_file_size_bytes; // Maximum size of a single file in the cache
 
         mutable std::shared_mutex cache_mutex;
 
-        //Statistics;
-        mutable size_t cache_hits;
-        mutable size_t cache_misses;
+        // Single-flight loads in progress, keyed by file path
+        std::unordered_map<std::string, std::shared_future<std::shared_ptr<const CachedFile>>> inflight_loads;
+        std::mutex inflight_mutex;
+
+        // Checks restored entries against the current file version on first hit
+        std::function<bool(const std::string&, const CachedFile&)> validator;
+
+        // Statistics. Counters are striped per thread so the request path never
+        // contends on them and reading them needs no lock.
+        StripedCounter cache_hits;
+        StripedCounter cache_misses;
+        StripedCounter hit_bytes;
+        StripedCounter miss_bytes;        // Bytes delivered by loads after misses
+        StripedCounter evictions;
+        StripedCounter rejects_too_large;
+        StripedCounter rejects_admission;
+        StripedCounter loads_executed;
+        StripedCounter loads_coalesced;
+        StripedCounter load_nanos;        // Time spent inside loaders
+        std::atomic<uint64_t> max_load_nanos;
+        StripedCounter l1_hits;
+        StripedCounter l1_misses;
+
+        // Bumped whenever an entry is replaced or invalidated; per-thread L1
+        // caches drop their handles when it moves. Kept on its own cache line
+        // so the writes above never disturb readers of it.
+        alignas(64) std::atomic<uint64_t> invalidation_epoch;
+
+        const uint64_t instance_id; // Distinguishes caches that reuse an address
 
     public:
-        LRUFileCache(size_t capacity_mb = 100, size_t max_file_mb = 20)
-        : capacity_bytes(capacity_mb * 1024 * 1024),
-          current_size_bytes(0), max_file_size_bytes(max_file_mb * 1024 * 1024),
-          cache_hits(0), cache_misses(0)
+        LRUFileCache(size_t capacity_mb = 100, size_t max_file_mb = 20,
+                     CachePolicyType policy_type = CachePolicyType::WTinyLFU,
+                     CacheBackend backend = CacheBackend::Locked)
+        : entry_count(0), capacity_bytes(capacity_mb * 1024 * 1024),
+          current_size_bytes(0), current_memory_bytes(0), pinned_bytes(0), pinned_memory_bytes(0),
+          max_file_size_bytes(max_file_mb * 1024 * 1024),
+          max_load_nanos(0), invalidation_epoch(0), instance_id(nextInstanceId())
         {
-            head = std::make_shared<CacheNode>("head", CachedFile("", ""));
-            tail = std::make_shared<CacheNode>("tail", CachedFile("", ""));
-            head->next = tail;
-            tail->prev = head;
+            if (backend == CacheBackend::RCU) {
+                // Readers cannot reorder a shared list without a lock, so the
+                // RCU backend always evicts by the reference bits they set
+                rcu = std::make_unique<RcuFileIndex>();
+                policy = std::make_unique<ClockPolicy>(capacity_bytes,
+                    [index = rcu.get()](SlotId slot) { return index->testAndClearReferenced(slot); });
+            } else {
+                policy = makeCachePolicy(policy_type, capacity_bytes);
+            }
 
-            std::cout << "[FileCache] LRU Cache initialized: "
+            std::cout << "[FileCache] " << policy->name() << " Cache initialized: "
                       << capacity_mb << " MB capacity, "
-                      << max_file_mb << " MB max file size." << std::endl;
+                      << max_file_mb << " MB max file size"
+                      << (rcu ? ", lock-free reads (RCU)." : ".") << std::endl;
         }
 
-        std::shared_ptr<CachedFile> get(const std::string& file_path)
+        using Loader = std::function<std::shared_ptr<const CachedFile>()>;
+        using Validator = std::function<bool(const std::string& file_path, const CachedFile& file)>;
+
+        // One exported entry, used to persist the cache across restarts
+        struct SnapshotEntry
+        {
+            std::string key;
+            std::shared_ptr<const CachedFile> file;
+            bool pinned;
+            uint32_t frequency;
+        };
+
+        std::shared_ptr<const CachedFile> get(const std::string& file_path)
         {
+            uint64_t hash = hashKey(file_path);
+            if (rcu)
+            {
+                // Validated hits and plain misses never take the lock. Entries
+                // still awaiting validation go through the locked path below.
+                EpochGuard guard;
+                RcuFileIndex::LookupResult found;
+                if (guard.entered())
+                {
+                    if (!rcu->lookup(file_path, hash, found, true)) {
+                        cache_misses.add();
+                        return nullptr;
+                    }
+                    if (found.validated) {
+                        cache_hits.add();
+                        hit_bytes.add(found.file->size_bytes);
+                        return found.file;
+                    }
+                }
+            }
+
             std::unique_lock<std::shared_mutex> lock(cache_mutex);
 
-            auto it = cache_map.find(file_path);
-            if (it != cache_map.end())
+            SlotId slot = findSlot(file_path, hash);
+            if (slot != kNoSlot && !entries[slot].validated)
+            {
+                // Lazily validate entries restored from a snapshot
+                if (validator && !validator(file_path, *entries[slot].file))
+                {
+                    std::cout << "[FileCache] Dropping stale restored entry: " << file_path << std::endl;
+                    eraseEntry(slot);
+                    slot = kNoSlot;
+                }
+                else
+                {
+                    entries[slot].validated = true;
+                    if (rcu) {
+                        rcu->setValidated(slot, true);
+                    }
+                }
+            }
+
+            if (slot != kNoSlot)
             {
-                auto node = it->second;
-                move_to_front(node);
-                cache_hits++;
+                CacheEntry& entry = entries[slot];
+                if (!entry.pinned) {
+                    policy->onHit(slot);
+                }
+                cache_hits.add();
+                hit_bytes.add(entry.file->size_bytes);
 
-                std::cout << "[FileCache] Cache hit for: " << file_path 
-                          << " (" << node->file.size_bytes << " bytes)" << std::endl;          
-                
-                return std::make_shared<CachedFile>(it->second->file);
+                if (logOperations()) {
+                    std::cout << "[FileCache] Cache hit for: " << file_path 
+                              << " (" << entry.file->size_bytes << " bytes)" << std::endl;
+                }
+
+                return entry.file;
             }
              
-            cache_misses++;
-            std::cout << "[FileCache] Cache miss for: " << file_path << std::endl;
+            policy->recordAccess(hash);
+            cache_misses.add();
+            if (logOperations()) {
+                std::cout << "[FileCache] Cache miss for: " << file_path << std::endl;
+            }
             return nullptr;
         }
 
-        bool put(const std::string& file_path, const CachedFile& file_data)
+        // Single-flight load after a miss: the first caller for a key runs
+        // `loader` and inserts the result, concurrent callers for the same key
+        // wait for that load and share its result. A failed load (nullptr or an
+        // exception) is delivered to every waiter instead of being retried by each.
+        std::shared_ptr<const CachedFile> load(const std::string& file_path, const Loader& loader)
+        {
+            std::promise<std::shared_ptr<const CachedFile>> promise;
+            std::shared_future<std::shared_ptr<const CachedFile>> result;
+            bool leader = false;
+            {
+                std::lock_guard<std::mutex> lock(inflight_mutex);
+                auto it = inflight_loads.find(file_path);
+                if (it != inflight_loads.end())
+                {
+                    result = it->second;
+                    loads_coalesced.add();
+                }
+                else
+                {
+                    result = promise.get_future().share();
+                    inflight_loads.emplace(file_path, result);
+                    leader = true;
+                }
+            }
+
+            if (!leader)
+            {
+                std::cout << "[FileCache] Waiting for in-flight load: " << file_path << std::endl;
+                return countMissBytes(result.get());
+            }
+
+            try
+            {
+                // Another leader may have finished between our miss and now
+                std::shared_ptr<const CachedFile> file = peek(file_path);
+                if (!file)
+                {
+                    loads_executed.add();
+                    auto start = std::chrono::steady_clock::now();
+                    file = loader();
+                    recordLoadLatency(std::chrono::steady_clock::now() - start);
+                    if (file) {
+                        put(file_path, file);
+                    }
+                }
+                promise.set_value(file);
+            }
+            catch (...)
+            {
+                promise.set_exception(std::current_exception());
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(inflight_mutex);
+                inflight_loads.erase(file_path);
+            }
+            return countMissBytes(result.get());
+        }
+
+        // Insert or replace an entry. Pinned entries bypass admission and are
+        // never evicted; they shrink the budget the policy manages instead.
+        bool put(const std::string& file_path, const CachedFile& file_data, bool pin = false)
+        {
+            return put(file_path, std::make_shared<const CachedFile>(file_data), pin);
+        }
+
+        bool put(const std::string& file_path, std::shared_ptr<const CachedFile> file, bool pin = false)
         {
             std::unique_lock<std::shared_mutex> lock(cache_mutex);
+            const CachedFile& file_data = *file;
 
             if(file_data.size_bytes > max_file_size_bytes)
             {
                 std::cout << "[FileCache] File too large to cache: " << file_path 
                           << " (" << file_data.size_bytes << " bytes, max: " 
                           << max_file_size_bytes << " bytes)" << std::endl;
+                rejects_too_large.add();
+                return false;
+            }
+
+            uint64_t hash = hashKey(file_path);
+            SlotId existing = findSlot(file_path, hash);
+            bool updating = existing != kNoSlot;
+            // An update keeps the pin; the old entry stays until the new one
+            // is known to fit, so a rejected update leaves it cached
+            pin = pin || (updating && entries[existing].pinned);
+
+            size_t charge = chargeFor(file_path, file_data);
+            size_t replaced_pin = updating && entries[existing].pinned ? entries[existing].charge : 0;
+            if (pin && pinned_memory_bytes - replaced_pin + charge > capacity_bytes)
+            {
+                std::cout << "[FileCache] Cannot pin " << file_path 
+                          << ": pinned entries would exceed capacity" << std::endl;
                 return false;
             }
 
-            auto it = cache_map.find(file_path);
-            if (it != cache_map.end())
+            if (updating && pin)
+            {
+                // Pinning cannot be refused past the check above
+                eraseEntry(existing);
+                existing = kNoSlot;
+            }
+
+            SlotId slot = allocateSlot();
+            std::vector<SlotId> evicted;
+            if (pin)
+            {
+                pinned_bytes += file_data.size_bytes;
+                pinned_memory_bytes += charge;
+                policy->setCapacity(capacity_bytes - pinned_memory_bytes, evicted);
+            }
+            else
+            {
+                policy->onInsert(slot, hash, charge, evicted);
+            }
+
+            bool admitted = true;
+            for (SlotId victim : evicted)
             {
-                auto node = it->second;
-                current_size_bytes -= node->file.size_bytes;
-                node->file = file_data; // Update existing file data
-                current_size_bytes += file_data.size_bytes;
-                move_to_front(node);
+                if (victim == slot) {
+                    admitted = false;
+                    continue;
+                }
+                if (victim == existing) {
+                    existing = kNoSlot;  // The policy dropped the old version itself
+                }
+                evict(victim);
+            }
 
-                std::cout << "[FileCache] Updated cache for: " << file_path 
-                          << " (" << file_data.size_bytes << " bytes)" << std::endl;
-                return true;
+            if (!admitted)
+            {
+                free_slots.push_back(slot);
+                rejects_admission.add();
+                std::cout << "[FileCache] Admission rejected by " << policy->name() << ": " 
+                          << file_path << " (" << file_data.size_bytes << " bytes)" << std::endl;
+                return false;
             }
 
-            // Make space if needed
-            while(current_size_bytes + file_data.size_bytes > capacity_bytes && !cache_map.empty())
+            if (existing != kNoSlot)
             {
-                evict_lru();
+                eraseEntry(existing);
             }
 
-            // Create new node and add to front
-            auto new_node = std::make_shared<CacheNode>(file_path, file_data);
-            cache_map[file_path] = new_node;
-            add_to_front(new_node);
+            CacheEntry& entry = entries[slot];
+            entry.key = file_path;
+            entry.file = std::move(file);
+            entry.hash = hash;
+            entry.charge = charge;
+            entry.pinned = pin;
+            entry.validated = true;
+            entry.in_use = true;
+            index.insert(hash, slot);
+            if (rcu) {
+                rcu->insert(file_path, hash, slot, entry.file, true);
+            }
+            entry_count++;
             current_size_bytes += file_data.size_bytes;
-            std::cout << "[FileCache] Added to cache: " << file_path 
-                      << " (" << file_data.size_bytes << " bytes)" 
-                      << " | Total: " << (current_size_bytes / 1024) << "KB" << std::endl;
+            current_memory_bytes += charge;
+            if (logOperations()) {
+                std::cout << "[FileCache] " << (updating ? "Updated cache for: " : "Added to cache: ") << file_path 
+                          << " (" << file_data.size_bytes << " bytes" << (pin ? ", pinned" : "") << ")" 
+                          << " | Total: " << (current_size_bytes / 1024) << "KB" << std::endl;
+            }
             
             return true;
         }
 
+        // Check residency without touching statistics or policy state
+        bool contains(const std::string& file_path) const
+        {
+            return peek(file_path) != nullptr;
+        }
+
+        // Lookup without touching statistics or policy state
+        std::shared_ptr<const CachedFile> peek(const std::string& file_path) const
+        {
+            if (rcu)
+            {
+                EpochGuard guard;
+                RcuFileIndex::LookupResult found;
+                if (guard.entered()) {
+                    return rcu->lookup(file_path, hashKey(file_path), found, false) ? found.file : nullptr;
+                }
+            }
+
+            std::shared_lock<std::shared_mutex> lock(cache_mutex);
+            SlotId slot = findSlot(file_path, hashKey(file_path));
+            return slot != kNoSlot ? entries[slot].file : nullptr;
+        }
+
+        // Drop a single entry (e.g. the file changed on disk)
+        bool remove(const std::string& file_path)
+        {
+            std::unique_lock<std::shared_mutex> lock(cache_mutex);
+
+            SlotId slot = findSlot(file_path, hashKey(file_path));
+            if (slot == kNoSlot) {
+                return false;
+            }
+
+            eraseEntry(slot);
+
+            std::cout << "[FileCache] Invalidated: " << file_path << std::endl;
+            return true;
+        }
+
+        // Drop every entry whose key starts with `prefix` (directory replaced/removed)
+        size_t removePrefix(const std::string& prefix)
+        {
+            std::unique_lock<std::shared_mutex> lock(cache_mutex);
+
+            size_t removed = 0;
+            for (SlotId slot = 0; slot < entries.size(); slot++) {
+                if (entries[slot].in_use && entries[slot].key.compare(0, prefix.size(), prefix) == 0) {
+                    eraseEntry(slot);
+                    removed++;
+                }
+            }
+
+            std::cout << "[FileCache] Invalidated " << removed << " entries under: " << prefix << std::endl;
+            return removed;
+        }
+
+        // Install the check used for restored entries (nullptr to remove)
+        void setValidator(Validator new_validator)
+        {
+            std::unique_lock<std::shared_mutex> lock(cache_mutex);
+            validator = std::move(new_validator);
+        }
+
+        // Entries in priority order (pinned first, then the policy's order)
+        std::vector<SnapshotEntry> exportEntries() const
+        {
+            std::shared_lock<std::shared_mutex> lock(cache_mutex);
+
+            std::vector<SnapshotEntry> result;
+            result.reserve(entry_count);
+            for (const auto& entry : entries) {
+                if (entry.in_use && entry.pinned) {
+                    result.push_back({entry.key, entry.file, true, 0});
+                }
+            }
+            for (SlotId slot : policy->slots()) {
+                const CacheEntry& entry = entries[slot];
+                result.push_back({entry.key, entry.file, false, policy->frequency(entry.hash)});
+            }
+            return result;
+        }
+
+        // Re-insert an exported entry. It is only trusted after the validator
+        // accepts it on its first hit.
+        bool restore(const SnapshotEntry& entry)
+        {
+            {
+                // Seed popularity first so admission sees it
+                std::unique_lock<std::shared_mutex> lock(cache_mutex);
+                policy->seedFrequency(hashKey(entry.key), entry.frequency);
+            }
+
+            if (!put(entry.key, entry.file, entry.pinned)) {
+                return false;
+            }
+
+            std::unique_lock<std::shared_mutex> lock(cache_mutex);
+            SlotId slot = findSlot(entry.key, hashKey(entry.key));
+            if (slot != kNoSlot) {
+                entries[slot].validated = false;
+                if (rcu) {
+                    rcu->setValidated(slot, false);
+                }
+            }
+            return true;
+        }
+
+        uint64_t instanceId() const { return instance_id; }
+
+        // Log lines for every hit, miss, insert and eviction, on by default.
+        // Formatting them costs more than the lookup itself, so benchmarks
+        // turn them off to measure the cache alone.
+        static void setOperationLogging(bool enabled)
+        {
+            operationLogging().store(enabled, std::memory_order_relaxed);
+        }
+
+        // Files larger than this are never cached
+        size_t getMaxFileSize() const { return max_file_size_bytes; }
+
+        uint64_t invalidationEpoch() const
+        {
+            return invalidation_epoch.load(std::memory_order_acquire);
+        }
+
+        // L1 caches report their counters in batches
+        void recordL1(size_t hits, size_t misses)
+        {
+            l1_hits.add(hits);
+            l1_misses.add(misses);
+        }
+
         // Get cache statistics
         struct CacheStats
         {
@@ -142,38 +558,111 @@ class LRUFileCache
             double hit_ratio;
             size_t hits;
             size_t misses;
+            size_t pinned_bytes;
+            size_t loads_executed;   // Loader runs after misses
+            size_t loads_coalesced;  // Misses that shared another thread's load
+            size_t memory_bytes;     // Slab blocks plus metadata, what capacity_bytes bounds
+            size_t l1_hits;          // Served from a worker's thread-local L1
+            size_t l1_misses;        // L1 lookups that fell through to this cache
+            double l1_hit_ratio;
+            double byte_hit_ratio;   // Hit bytes over hit plus loaded bytes
+            size_t hit_bytes;
+            size_t miss_bytes;
+            size_t evictions;
+            size_t rejects_too_large;
+            size_t rejects_admission;
+            double avg_load_latency_us;
+            double max_load_latency_us;
         };
 
+        // Lock-free: sums the striped counters and reads the gauges, so polling
+        // it never competes with requests for the cache lock. Values are
+        // individually exact but not a consistent snapshot of one instant.
         CacheStats getStats() const{
-            std::shared_lock<std::shared_mutex> lock(cache_mutex);
-            
-            double hit_ratio = 0;
-            size_t total_requests = cache_hits + cache_misses;
-            if (total_requests > 0)
-            {
-                hit_ratio = static_cast<double>(cache_hits) / total_requests;
+            CacheStats stats{};
+            stats.entries = entry_count.load(std::memory_order_relaxed);
+            stats.size_bytes = current_size_bytes.load(std::memory_order_relaxed);
+            stats.capacity_bytes = capacity_bytes.load(std::memory_order_relaxed);
+            stats.pinned_bytes = pinned_bytes.load(std::memory_order_relaxed);
+            stats.memory_bytes = current_memory_bytes.load(std::memory_order_relaxed);
+
+            stats.hits = cache_hits.load();
+            stats.misses = cache_misses.load();
+            stats.hit_ratio = ratio(stats.hits, stats.misses);
+            stats.hit_bytes = hit_bytes.load();
+            stats.miss_bytes = miss_bytes.load();
+            stats.byte_hit_ratio = ratio(stats.hit_bytes, stats.miss_bytes);
+            stats.evictions = evictions.load();
+            stats.rejects_too_large = rejects_too_large.load();
+            stats.rejects_admission = rejects_admission.load();
+
+            stats.loads_executed = loads_executed.load();
+            stats.loads_coalesced = loads_coalesced.load();
+            if (stats.loads_executed > 0) {
+                stats.avg_load_latency_us = load_nanos.load() / 1000.0 / stats.loads_executed;
             }
+            stats.max_load_latency_us = max_load_nanos.load(std::memory_order_relaxed) / 1000.0;
 
-            return CacheStats{
-                cache_map.size(),
-                current_size_bytes,
-                capacity_bytes,
-                hit_ratio,
-                cache_hits,
-                cache_misses
-            };
+            stats.l1_hits = l1_hits.load();
+            stats.l1_misses = l1_misses.load();
+            stats.l1_hit_ratio = ratio(stats.l1_hits, stats.l1_misses);
+            return stats;
+        }
+
+        // Change the memory budget at runtime. Entries that no longer fit are
+        // evicted in one batch under a single lock; pinned entries always stay,
+        // so the budget never drops below what they use.
+        size_t setCapacity(size_t new_capacity_bytes)
+        {
+            std::unique_lock<std::shared_mutex> lock(cache_mutex);
+
+            capacity_bytes = std::max(new_capacity_bytes, pinned_memory_bytes);
+            size_t budget = capacity_bytes;
+            std::vector<SlotId> evicted;
+            policy->setCapacity(budget - pinned_memory_bytes, evicted);
+
+            size_t freed = current_memory_bytes;
+            for (SlotId slot : evicted) {
+                retireShared(slot);
+                releaseSlot(slot);
+            }
+            freed -= current_memory_bytes;
+            evictions.add(evicted.size());
+
+            std::cout << "[FileCache] Capacity set to " << (budget / 1024) << "KB";
+            if (!evicted.empty()) {
+                std::cout << ", evicted " << evicted.size() << " entries (" << (freed / 1024) << "KB)";
+            }
+            std::cout << std::endl;
+            return evicted.size();
         }
 
         // Clear all cached files
         void clear() {
             std::unique_lock<std::shared_mutex> lock(cache_mutex);
             
-            cache_map.clear();
-            head->next = tail;
-            tail->prev = head;
+            entries.clear();
+            free_slots.clear();
+            index.clear();
+            if (rcu) {
+                rcu->clear();
+            }
+            invalidation_epoch.fetch_add(1, std::memory_order_release);
+            entry_count = 0;
+            policy->clear();
+            std::vector<SlotId> evicted;
+            policy->setCapacity(capacity_bytes, evicted);
             current_size_bytes = 0;
-            cache_hits = 0;
-            cache_misses = 0;
+            current_memory_bytes = 0;
+            pinned_bytes = 0;
+            pinned_memory_bytes = 0;
+            for (StripedCounter* counter : {&cache_hits, &cache_misses, &hit_bytes, &miss_bytes,
+                                            &evictions, &rejects_too_large, &rejects_admission,
+                                            &loads_executed, &loads_coalesced, &load_nanos,
+                                            &l1_hits, &l1_misses}) {
+                counter->reset();
+            }
+            max_load_nanos = 0;
             
             std::cout << "[FileCache] Cache cleared" << std::endl;
         }
@@ -181,56 +670,140 @@ class LRUFileCache
         void print_cache_state() const {
             std::shared_lock<std::shared_mutex> lock(cache_mutex);
             
-            std::cout << "[FileCache] Current state:" << std::endl;
-            std::cout << "  Entries: " << cache_map.size() << std::endl;
-            std::cout << "  Size: " << (current_size_bytes / 1024) << "KB / " 
-                    << (capacity_bytes / 1024) << "KB" << std::endl;
+            std::cout << "[FileCache] Current state (" << policy->name() << (rcu ? ", RCU" : "") << "):" << std::endl;
+            std::cout << "  Entries: " << entry_count << std::endl;
+            std::cout << "  Size: " << (current_size_bytes / 1024) << "KB in "
+                    << (current_memory_bytes / 1024) << "KB / "
+                    << (capacity_bytes / 1024) << "KB (" << (pinned_bytes / 1024) << "KB pinned)" << std::endl;
             
-            std::cout << "  Files (most recent first): ";
-            auto current = head->next;
-            while (current != tail) {
-                std::cout << current->key << " ";
-                current = current->next;
+            std::cout << "  Pinned files: ";
+            for (const auto& entry : entries) {
+                if (entry.in_use && entry.pinned) {
+                    std::cout << entry.key << " ";
+                }
+            }
+            std::cout << std::endl;
+
+            std::cout << "  Files (highest priority first): ";
+            for (SlotId slot : policy->slots()) {
+                std::cout << entries[slot].key << " ";
             }
             std::cout << std::endl;
     }
 
+        // Budget charge of a file of `body_bytes` under a `key_bytes` long key,
+        // not counting its MIME type and ETag strings. Used for capacity planning.
+        static size_t estimateCharge(size_t key_bytes, size_t body_bytes) {
+            return SegmentedBuffer::memoryBytesFor(body_bytes) + sizeof(CachedFile) +
+                   CachedFile::kSharedControlBytes + key_bytes + kEntryOverheadBytes;
+        }
+
     private:
-        void move_to_front(std::shared_ptr<CacheNode> node) {
-            // Remove from current position
-            node->prev->next = node->next;
-            node->next->prev = node->prev;
-            
-            // Add to front
-            add_to_front(node);
+        static std::atomic<bool>& operationLogging() {
+            static std::atomic<bool> enabled{true};
+            return enabled;
         }
-        
-        // Add new node to front
-        void add_to_front(std::shared_ptr<CacheNode> node) {
-            node->next = head->next;
-            node->prev = head;
-            head->next->prev = node;
-            head->next = node;
+
+        static bool logOperations() {
+            return operationLogging().load(std::memory_order_relaxed);
         }
-        
-        void evict_lru() {
-            auto lru_node = tail->prev;
-            if (lru_node == head) {
-                return; // Cache is empty
+
+        static uint64_t nextInstanceId() {
+            static std::atomic<uint64_t> next_id{1};
+            return next_id.fetch_add(1);
+        }
+
+        // Slot, policy node and index bucket of one entry
+        static constexpr size_t kEntryOverheadBytes = sizeof(CacheEntry) + sizeof(PolicyNode) + 16;
+
+        static double ratio(size_t part, size_t rest) {
+            return part + rest > 0 ? static_cast<double>(part) / (part + rest) : 0.0;
+        }
+
+        std::shared_ptr<const CachedFile> countMissBytes(std::shared_ptr<const CachedFile> file) {
+            if (file) {
+                miss_bytes.add(file->size_bytes);
+            }
+            return file;
+        }
+
+        void recordLoadLatency(std::chrono::steady_clock::duration elapsed) {
+            uint64_t nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+            load_nanos.add(nanos);
+            uint64_t seen = max_load_nanos.load(std::memory_order_relaxed);
+            while (nanos > seen && !max_load_nanos.compare_exchange_weak(seen, nanos, std::memory_order_relaxed)) {
+            }
+        }
+
+        static size_t chargeFor(const std::string& key, const CachedFile& file) {
+            return file.memory_bytes + key.size() + kEntryOverheadBytes;
+        }
+
+        static uint64_t hashKey(const std::string& key) {
+            return std::hash<std::string_view>{}(key);
+        }
+
+        SlotId findSlot(const std::string& key, uint64_t hash) const {
+            return index.find(hash, [&](SlotId slot) { return entries[slot].key == key; });
+        }
+
+        SlotId allocateSlot() {
+            if (!free_slots.empty()) {
+                SlotId slot = free_slots.back();
+                free_slots.pop_back();
+                return slot;
+            }
+            entries.emplace_back();
+            return static_cast<SlotId>(entries.size() - 1);
+        }
+
+        void releaseSlot(SlotId slot) {
+            CacheEntry& entry = entries[slot];
+            current_size_bytes -= entry.file->size_bytes;
+            current_memory_bytes -= entry.charge;
+            index.erase(entry.hash, slot);
+            if (rcu) {
+                rcu->erase(entry.key, entry.hash);
+            }
+            entry = CacheEntry{};
+            free_slots.push_back(slot);
+            entry_count--;
+        }
+
+        // Drop an entry the policy chose as a victim (policy already forgot it)
+        void evict(SlotId slot) {
+            if (logOperations()) {
+                std::cout << "[FileCache] Evicting (" << policy->name() << "): " << entries[slot].key 
+                        << " (" << entries[slot].file->size_bytes << " bytes)" << std::endl;
+            }
+            evictions.add();
+            retireShared(slot);
+            releaseSlot(slot);
+        }
+
+        // A body someone else still holds may sit in an L1, which would keep
+        // the evicted memory alive; moving the epoch makes every L1 let go
+        void retireShared(SlotId slot) {
+            if (entries[slot].file.use_count() > 1) {
+                invalidation_epoch.fetch_add(1, std::memory_order_release);
+            }
+        }
+
+        // Remove an entry on the cache's own initiative (update/invalidation)
+        void eraseEntry(SlotId slot) {
+            invalidation_epoch.fetch_add(1, std::memory_order_release);
+            const CacheEntry& entry = entries[slot];
+            if (entry.pinned) {
+                // Give the unpinned bytes back to the policy
+                pinned_bytes -= entry.file->size_bytes;
+                pinned_memory_bytes -= entry.charge;
+                releaseSlot(slot);
+                std::vector<SlotId> evicted;
+                policy->setCapacity(capacity_bytes - pinned_memory_bytes, evicted);
+            } else {
+                policy->onRemove(slot);
+                releaseSlot(slot);
             }
-            
-            std::cout << "[FileCache] Evicting LRU: " << lru_node->key 
-                    << " (" << lru_node->file.size_bytes << " bytes)" << std::endl;
-            
-            // Remove from map
-            cache_map.erase(lru_node->key);
-            
-            // Remove from linked list
-            lru_node->prev->next = lru_node->next;
-            lru_node->next->prev = lru_node->prev;
-            
-            // Update size
-            current_size_bytes -= lru_node->file.size_bytes;
         }
 };
 
@@ -241,8 +814,10 @@ public:
     FileCacheManager& operator=(const FileCacheManager&) = delete;
 
     // Cho phép khởi tạo tùy biến 1 lần (nếu bạn thực sự cần)
-    static LRUFileCache& get_instance(size_t capacity_mb = 100, size_t max_file_mb = 20) {
-        static LRUFileCache instance(capacity_mb, max_file_mb);
+    static LRUFileCache& get_instance(size_t capacity_mb = 100, size_t max_file_mb = 20,
+                                      CachePolicyType policy_type = CachePolicyType::WTinyLFU,
+                                      CacheBackend backend = CacheBackend::Locked) {
+        static LRUFileCache instance(capacity_mb, max_file_mb, policy_type, backend);
         return instance;
     }
 };
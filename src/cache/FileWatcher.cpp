@@ -0,0 +1,148 @@
+#include "FileWatcher.h"
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <filesystem>
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+
+namespace {
+    constexpr uint32_t kWatchMask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM |
+                                    IN_DELETE | IN_CREATE | IN_ATTRIB | IN_DELETE_SELF;
+    constexpr int kPollTimeoutMs = 200;
+}
+
+FileWatcher::FileWatcher(const std::string& root, Callback callback)
+    : root(root), callback(std::move(callback)), inotify_fd(-1), running(false) {
+}
+
+FileWatcher::~FileWatcher() {
+    stop();
+}
+
+bool FileWatcher::start() {
+    if (running.load()) {
+        return true;
+    }
+
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd < 0) {
+        std::cerr << "[FileWatcher] inotify_init1() failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    addWatchRecursive("");
+    if (watch_dirs.empty()) {
+        std::cerr << "[FileWatcher] Nothing to watch under " << root << std::endl;
+        close(inotify_fd);
+        inotify_fd = -1;
+        return false;
+    }
+
+    running.store(true);
+    watcher_thread = std::thread(&FileWatcher::watchLoop, this);
+
+    std::cout << "[FileWatcher] Watching " << root << " (" << watch_dirs.size()
+              << " directories)" << std::endl;
+    return true;
+}
+
+void FileWatcher::stop() {
+    running.store(false);
+    if (watcher_thread.joinable()) {
+        watcher_thread.join();
+        std::cout << "[FileWatcher] Stopped watching " << root << std::endl;
+    }
+    if (inotify_fd != -1) {
+        close(inotify_fd);
+        inotify_fd = -1;
+    }
+    watch_dirs.clear();
+}
+
+void FileWatcher::addWatchRecursive(const std::string& relative_dir) {
+    std::string full_path = root + relative_dir;
+    int wd = inotify_add_watch(inotify_fd, full_path.c_str(), kWatchMask);
+    if (wd < 0) {
+        std::cerr << "[FileWatcher] Cannot watch " << full_path << ": " << strerror(errno) << std::endl;
+        return;
+    }
+    watch_dirs[wd] = relative_dir;
+
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(full_path, ec)) {
+        if (entry.is_directory(ec)) {
+            addWatchRecursive(relative_dir + "/" + entry.path().filename().string());
+        }
+    }
+}
+
+void FileWatcher::watchLoop() {
+    alignas(struct inotify_event) char buffer[16 * 1024];
+
+    while (running.load()) {
+        struct pollfd pfd = {inotify_fd, POLLIN, 0};
+        int ready = poll(&pfd, 1, kPollTimeoutMs);
+        if (ready <= 0) {
+            continue;
+        }
+
+        ssize_t length = read(inotify_fd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            continue;
+        }
+
+        for (char* ptr = buffer; ptr < buffer + length; ) {
+            auto* event = reinterpret_cast<struct inotify_event*>(ptr);
+            std::string name = event->len ? std::string(event->name) : "";
+            handleEvent(event->wd, event->mask, name);
+            ptr += sizeof(struct inotify_event) + event->len;
+        }
+    }
+}
+
+void FileWatcher::handleEvent(int wd, uint32_t mask, const std::string& name) {
+    if (mask & IN_Q_OVERFLOW) {
+        // Lost events: everything may be stale
+        std::cout << "[FileWatcher] Event queue overflow, invalidating everything" << std::endl;
+        callback("/", FileEvent::DirectoryChanged);
+        return;
+    }
+
+    auto it = watch_dirs.find(wd);
+    if (it == watch_dirs.end()) {
+        return;
+    }
+
+    if (mask & IN_IGNORED) {
+        watch_dirs.erase(it);
+        return;
+    }
+
+    if (mask & IN_DELETE_SELF) {
+        callback(it->second.empty() ? "/" : it->second, FileEvent::DirectoryChanged);
+        return;
+    }
+
+    std::string path = it->second + "/" + name;
+
+    if (mask & IN_ISDIR) {
+        if (mask & (IN_CREATE | IN_MOVED_TO)) {
+            addWatchRecursive(path);
+        }
+        if (mask & (IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE)) {
+            std::cout << "[FileWatcher] Directory changed: " << path << std::endl;
+            callback(path, FileEvent::DirectoryChanged);
+        }
+        return;
+    }
+
+    if (mask & (IN_DELETE | IN_MOVED_FROM)) {
+        std::cout << "[FileWatcher] File removed: " << path << std::endl;
+        callback(path, FileEvent::Deleted);
+    } else if (mask & (IN_CLOSE_WRITE | IN_MOVED_TO | IN_ATTRIB)) {
+        std::cout << "[FileWatcher] File changed: " << path << std::endl;
+        callback(path, FileEvent::Modified);
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+#include <string>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <unordered_map>
+#include <cstdint>
+
+enum class FileEvent {
+    Modified,          // File written (close after write) or moved into place
+    Deleted,           // File deleted or moved away
+    DirectoryChanged   // Whole subtree replaced/removed (or event queue overflowed)
+};
+
+// Background inotify watcher over a directory tree. Paths handed to the
+// callback are relative to the root and start with '/', matching cache keys.
+class FileWatcher
+{
+    public:
+        using Callback = std::function<void(const std::string& path, FileEvent event)>;
+
+    private:
+        std::string root;
+        Callback callback;
+        int inotify_fd;
+        std::thread watcher_thread;
+        std::atomic<bool> running;
+
+        // Watch descriptor -> directory relative to root ("" for root)
+        std::unordered_map<int, std::string> watch_dirs;
+
+    public:
+        FileWatcher(const std::string& root, Callback callback);
+        ~FileWatcher();
+
+        FileWatcher(const FileWatcher&) = delete;
+        FileWatcher& operator=(const FileWatcher&) = delete;
+
+        bool start();
+        void stop();
+        bool isRunning() const { return running.load(); }
+
+    private:
+        void watchLoop();
+        void addWatchRecursive(const std::string& relative_dir);
+        void handleEvent(int wd, uint32_t mask, const std::string& name);
+};
+
+#endif // FILE_WATCHER_H
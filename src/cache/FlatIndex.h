@@ -0,0 +1,124 @@
+#ifndef FLAT_INDEX_H
+#define FLAT_INDEX_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+using SlotId = uint32_t;
+constexpr SlotId kNoSlot = UINT32_MAX;
+
+// Open-addressing (linear probing) hash index from key hash to slot id.
+// Keys themselves live in the caller's slot array; lookups take an equality
+// callback so the index stays a flat array of 8-byte buckets holding the low
+// 32 bits of the hash and the slot. Deletion uses backward shifting, so there
+// are no tombstones to clean up.
+class FlatIndex
+{
+    private:
+        struct Bucket
+        {
+            uint32_t hash;
+            SlotId slot;
+        };
+
+        std::vector<Bucket> buckets;
+        size_t mask;
+        size_t count;
+
+    public:
+        explicit FlatIndex(size_t initial_capacity = 64)
+            : count(0)
+        {
+            size_t capacity = 16;
+            while (capacity < initial_capacity) {
+                capacity <<= 1;
+            }
+            buckets.assign(capacity, Bucket{0, kNoSlot});
+            mask = capacity - 1;
+        }
+
+        size_t size() const { return count; }
+        size_t bucketCount() const { return buckets.size(); }
+
+        template<class KeyEquals>
+        SlotId find(uint64_t hash, KeyEquals&& equals) const
+        {
+            uint32_t tag = static_cast<uint32_t>(hash);
+            for (size_t i = tag & mask; ; i = (i + 1) & mask) {
+                const Bucket& bucket = buckets[i];
+                if (bucket.slot == kNoSlot) {
+                    return kNoSlot;
+                }
+                if (bucket.hash == tag && equals(bucket.slot)) {
+                    return bucket.slot;
+                }
+            }
+        }
+
+        // Caller guarantees the key is not present yet
+        void insert(uint64_t hash, SlotId slot)
+        {
+            if ((count + 1) * 10 > buckets.size() * 7) {
+                grow();
+            }
+            place(static_cast<uint32_t>(hash), slot);
+            count++;
+        }
+
+        bool erase(uint64_t hash, SlotId slot)
+        {
+            size_t i = static_cast<uint32_t>(hash) & mask;
+            while (buckets[i].slot != slot) {
+                if (buckets[i].slot == kNoSlot) {
+                    return false;
+                }
+                i = (i + 1) & mask;
+            }
+
+            // Backward shift: pull later entries of the probe run into the hole
+            size_t hole = i;
+            for (size_t j = (hole + 1) & mask; buckets[j].slot != kNoSlot; j = (j + 1) & mask) {
+                size_t home = buckets[j].hash & mask;
+                if (((j - home) & mask) >= ((j - hole) & mask)) {
+                    buckets[hole] = buckets[j];
+                    hole = j;
+                }
+            }
+            buckets[hole] = Bucket{0, kNoSlot};
+            count--;
+            return true;
+        }
+
+        void clear()
+        {
+            std::fill(buckets.begin(), buckets.end(), Bucket{0, kNoSlot});
+            count = 0;
+        }
+
+    private:
+        void place(uint32_t hash, SlotId slot)
+        {
+            size_t i = hash & mask;
+            while (buckets[i].slot != kNoSlot) {
+                i = (i + 1) & mask;
+            }
+            buckets[i] = Bucket{hash, slot};
+        }
+
+        void grow()
+        {
+            std::vector<Bucket> old;
+            old.swap(buckets);
+            buckets.assign(old.size() * 2, Bucket{0, kNoSlot});
+            mask = buckets.size() - 1;
+            for (const auto& bucket : old) {
+                if (bucket.slot != kNoSlot) {
+                    place(bucket.hash, bucket.slot);
+                }
+            }
+        }
+};
+
+#endif // FLAT_INDEX_H
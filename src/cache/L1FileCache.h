@@ -0,0 +1,161 @@
+#ifndef L1_FILE_CACHE_H
+#define L1_FILE_CACHE_H
+
+#include <string>
+#include <memory>
+#include <array>
+#include <functional>
+#include <string_view>
+#include "FileCache.h"
+
+// Tiny per-thread cache of file handles in front of an LRUFileCache.
+//
+// Each worker keeps the handles of the files it served most recently in a
+// 2-way set associative table. A hit only reads thread-local memory and the
+// shared cache's invalidation epoch (which sits on its own, rarely written
+// cache line), so the hottest assets are served without taking the shared
+// lock. When the epoch moves the whole L1 is dropped. Every kSyncInterval-th
+// hit on an entry is still passed to the shared cache so its policy keeps
+// seeing the traffic and does not age hot files out.
+class L1FileCache
+{
+    public:
+        static constexpr size_t kSets = 16;
+        static constexpr size_t kWays = 2;
+        static constexpr size_t kMaxFileBytes = 256 * 1024;
+        static constexpr uint32_t kSyncInterval = 64;
+        static constexpr size_t kStatsBatch = 256;
+
+    private:
+        struct Line
+        {
+            std::string key;
+            uint64_t hash = 0;
+            std::shared_ptr<const CachedFile> file;
+            uint32_t hits_since_sync = 0;
+            bool recent = false; // Second-chance bit for replacement
+        };
+
+        std::array<Line, kSets * kWays> lines;
+        uint64_t owner_id = 0; // LRUFileCache::instanceId() of the cache behind this L1
+        uint64_t epoch = 0;
+
+        // Counters flushed to the shared cache every kStatsBatch lookups
+        size_t pending_hits = 0;
+        size_t pending_misses = 0;
+
+    public:
+        L1FileCache() = default;
+        L1FileCache(const L1FileCache&) = delete;
+        L1FileCache& operator=(const L1FileCache&) = delete;
+
+        // The calling thread's L1
+        static L1FileCache& local()
+        {
+            thread_local L1FileCache cache;
+            return cache;
+        }
+
+        std::shared_ptr<const CachedFile> get(LRUFileCache& shared, const std::string& key)
+        {
+            // Read the epoch before touching the shared cache so a concurrent
+            // invalidation is always noticed on the next lookup
+            uint64_t current_epoch = shared.invalidationEpoch();
+            if (shared.instanceId() != owner_id) {
+                // Counters of the previous cache are dropped, it may be gone
+                pending_hits = pending_misses = 0;
+                reset();
+                owner_id = shared.instanceId();
+                epoch = current_epoch;
+            } else if (current_epoch != epoch) {
+                reset();
+                epoch = current_epoch;
+            }
+
+            uint64_t hash = std::hash<std::string_view>{}(key);
+            Line* set = &lines[(hash % kSets) * kWays];
+            for (size_t way = 0; way < kWays; way++) {
+                Line& line = set[way];
+                if (line.file && line.hash == hash && line.key == key) {
+                    line.recent = true;
+                    if (++line.hits_since_sync < kSyncInterval) {
+                        countLookup(shared, true);
+                        return line.file;
+                    }
+                    // Periodic pass-through keeps the shared policy informed
+                    line.hits_since_sync = 0;
+                    break;
+                }
+            }
+
+            countLookup(shared, false);
+            auto file = shared.get(key);
+            if (file && file->size_bytes <= kMaxFileBytes) {
+                fill(set, key, hash, file);
+            }
+            return file;
+        }
+
+        // Hand the batched hit/miss counters to the shared cache's stats
+        void flushStats(LRUFileCache& shared)
+        {
+            if (shared.instanceId() == owner_id && (pending_hits || pending_misses)) {
+                shared.recordL1(pending_hits, pending_misses);
+            }
+            pending_hits = 0;
+            pending_misses = 0;
+        }
+
+        void reset()
+        {
+            for (auto& line : lines) {
+                line = Line{};
+            }
+        }
+
+    private:
+        void countLookup(LRUFileCache& shared, bool hit)
+        {
+            if (hit) {
+                pending_hits++;
+            } else {
+                pending_misses++;
+            }
+            if (pending_hits + pending_misses >= kStatsBatch) {
+                flushStats(shared);
+            }
+        }
+
+        void fill(Line* set, const std::string& key, uint64_t hash, std::shared_ptr<const CachedFile> file)
+        {
+            // Refresh in place, else take an empty way, else the first way without a second chance
+            Line* victim = nullptr;
+            for (size_t way = 0; way < kWays && !victim; way++) {
+                if (set[way].file && set[way].hash == hash && set[way].key == key) {
+                    victim = &set[way];
+                }
+            }
+            for (size_t way = 0; way < kWays && !victim; way++) {
+                if (!set[way].file) {
+                    victim = &set[way];
+                }
+            }
+            while (!victim) {
+                for (size_t way = 0; way < kWays && !victim; way++) {
+                    if (set[way].recent) {
+                        set[way].recent = false;
+                    } else {
+                        victim = &set[way];
+                    }
+                }
+            }
+
+            victim->key = key;
+            victim->hash = hash;
+            victim->file = std::move(file);
+            victim->hits_since_sync = 0;
+            victim->recent = false;
+        }
+};
+
+#endif // L1_FILE_CACHE_H
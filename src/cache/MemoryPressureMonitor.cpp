@@ -0,0 +1,189 @@
+#include "MemoryPressureMonitor.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+namespace {
+    constexpr size_t kMinGrowBytes = 1024 * 1024;
+
+    // memory.max / memory.current: a byte count, or "max" for no limit
+    bool readBytes(const std::string& path, size_t& value) {
+        std::ifstream in(path);
+        std::string text;
+        if (!(in >> text) || text == "max") {
+            return false;
+        }
+        try {
+            value = std::stoull(text);
+        } catch (const std::exception&) {
+            return false;
+        }
+        return true;
+    }
+}
+
+MemoryPressureMonitor::MemoryPressureMonitor(LRUFileCache& cache, Config config)
+    : cache(cache), config(std::move(config)), running(false) {
+    if (this->config.ceiling_bytes == 0) {
+        this->config.ceiling_bytes = cache.getStats().capacity_bytes;
+    }
+    this->config.ceiling_bytes = std::max(this->config.ceiling_bytes, this->config.floor_bytes);
+    if (this->config.cgroup_dir.empty()) {
+        this->config.cgroup_dir = discoverCgroupDir();
+    }
+}
+
+MemoryPressureMonitor::~MemoryPressureMonitor() {
+    stop();
+}
+
+bool MemoryPressureMonitor::start() {
+    if (running.load()) {
+        return true;
+    }
+
+    Sample sample = readSample();
+    if (!sample.has_limit && !sample.has_pressure) {
+        std::cout << "[MemoryPressure] No cgroup memory limit or PSI available, "
+                  << "keeping a fixed cache budget" << std::endl;
+        return false;
+    }
+
+    running.store(true);
+    monitor_thread = std::thread(&MemoryPressureMonitor::monitorLoop, this);
+
+    std::cout << "[MemoryPressure] Adapting cache budget between " << (config.floor_bytes / (1024 * 1024))
+              << "MB and " << (config.ceiling_bytes / (1024 * 1024)) << "MB";
+    if (sample.has_limit) {
+        std::cout << " (memory.max " << (sample.limit_bytes / (1024 * 1024)) << "MB)";
+    }
+    std::cout << std::endl;
+    return true;
+}
+
+void MemoryPressureMonitor::stop() {
+    {
+        std::lock_guard<std::mutex> lock(wait_mutex);
+        running.store(false);
+    }
+    wake.notify_all();
+    if (monitor_thread.joinable()) {
+        monitor_thread.join();
+        std::cout << "[MemoryPressure] Stopped" << std::endl;
+    }
+}
+
+void MemoryPressureMonitor::monitorLoop() {
+    std::unique_lock<std::mutex> lock(wait_mutex);
+    while (running.load()) {
+        lock.unlock();
+        adjust();
+        lock.lock();
+        wake.wait_for(lock, config.interval, [this] { return !running.load(); });
+    }
+}
+
+size_t MemoryPressureMonitor::adjust() {
+    Sample sample = readSample();
+    size_t current = cache.getStats().capacity_bytes;
+    size_t target = targetCapacity(sample, current);
+    if (target == current) {
+        return current;
+    }
+
+    std::cout << "[MemoryPressure] " << (target < current ? "Shrinking" : "Growing")
+              << " cache budget " << (current / 1024) << "KB -> " << (target / 1024) << "KB"
+              << " (usage " << (sample.usage_bytes / 1024) << "KB";
+    if (sample.has_limit) {
+        std::cout << " of " << (sample.limit_bytes / 1024) << "KB";
+    }
+    std::cout << ", psi some avg10 " << sample.some_avg10 << "%)" << std::endl;
+
+    cache.setCapacity(target);
+    return cache.getStats().capacity_bytes;
+}
+
+MemoryPressureMonitor::Sample MemoryPressureMonitor::readSample() const {
+    Sample sample;
+
+    if (!config.cgroup_dir.empty()) {
+        sample.has_limit = readBytes(config.cgroup_dir + "/memory.max", sample.limit_bytes) &&
+                           readBytes(config.cgroup_dir + "/memory.current", sample.usage_bytes);
+    }
+
+    // "some avg10=1.23 avg60=0.50 avg300=0.10 total=12345"
+    std::ifstream pressure(config.pressure_path);
+    std::string line;
+    while (std::getline(pressure, line)) {
+        std::istringstream fields(line);
+        std::string kind, field;
+        fields >> kind;
+        if (kind != "some") {
+            continue;
+        }
+        while (fields >> field) {
+            if (field.compare(0, 6, "avg10=") == 0) {
+                try {
+                    sample.some_avg10 = std::stod(field.substr(6));
+                    sample.has_pressure = true;
+                } catch (const std::exception&) {
+                }
+            }
+        }
+    }
+    return sample;
+}
+
+size_t MemoryPressureMonitor::targetCapacity(const Sample& sample, size_t current_capacity) const {
+    size_t ceiling = config.ceiling_bytes;
+    size_t headroom = 0;
+    bool low_headroom = false;
+    bool roomy = true;
+    if (sample.has_limit) {
+        ceiling = std::min(ceiling, static_cast<size_t>(sample.limit_bytes * config.max_limit_fraction));
+        headroom = sample.limit_bytes > sample.usage_bytes ? sample.limit_bytes - sample.usage_bytes : 0;
+        size_t low_watermark = static_cast<size_t>(sample.limit_bytes * config.low_headroom_fraction);
+        low_headroom = headroom < low_watermark;
+        roomy = headroom >= 2 * low_watermark;
+    }
+    ceiling = std::max(ceiling, config.floor_bytes);
+
+    bool stalled = sample.has_pressure && sample.some_avg10 >= config.pressure_high;
+    bool calm = !sample.has_pressure || sample.some_avg10 < config.pressure_low;
+
+    size_t target = current_capacity;
+    if (stalled || low_headroom) {
+        // Drop a whole step (or the missing headroom, if larger) in one go
+        size_t step = static_cast<size_t>(current_capacity * config.shrink_step);
+        if (low_headroom) {
+            size_t low_watermark = static_cast<size_t>(sample.limit_bytes * config.low_headroom_fraction);
+            step = std::max(step, low_watermark - headroom);
+        }
+        target = current_capacity > step ? current_capacity - step : 0;
+    } else if (calm && roomy) {
+        size_t step = std::max(static_cast<size_t>(current_capacity * config.grow_step), kMinGrowBytes);
+        if (sample.has_limit) {
+            step = std::min(step, headroom / 2);
+        }
+        target = current_capacity + step;
+    }
+
+    return std::clamp(target, config.floor_bytes, ceiling);
+}
+
+std::string MemoryPressureMonitor::discoverCgroupDir() {
+    // cgroup v2 has a single "0::/path" line
+    std::ifstream cgroup("/proc/self/cgroup");
+    std::string line;
+    while (std::getline(cgroup, line)) {
+        if (line.compare(0, 3, "0::") == 0) {
+            std::string dir = "/sys/fs/cgroup" + line.substr(3);
+            if (!dir.empty() && dir.back() == '/') {
+                dir.pop_back();
+            }
+            return dir;
+        }
+    }
+    return "";
+}
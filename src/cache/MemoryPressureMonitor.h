@@ -0,0 +1,77 @@
+#ifndef MEMORY_PRESSURE_MONITOR_H
+#define MEMORY_PRESSURE_MONITOR_H
+
+#include <string>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include "FileCache.h"
+
+// Resizes the file cache at runtime from the container's memory situation.
+//
+// Every interval it samples cgroup v2 memory.max / memory.current and the
+// "some avg10" line of the memory PSI file. Under pressure (stall time above
+// pressure_high, or headroom below the low watermark) the budget shrinks by a
+// whole step at once so eviction happens in one batch; once pressure is gone
+// and there is room again it grows back step by step. The budget always stays
+// within [floor, ceiling], and never above max_limit_fraction of memory.max.
+class MemoryPressureMonitor
+{
+    public:
+        struct Config
+        {
+            size_t floor_bytes = 8 * 1024 * 1024;
+            size_t ceiling_bytes = 0;             // 0: the cache's capacity at construction
+            double max_limit_fraction = 0.5;      // Share of memory.max the cache may use
+            double pressure_high = 10.0;          // PSI some avg10 (%) that triggers a shrink
+            double pressure_low = 1.0;            // PSI some avg10 (%) below which we may grow
+            double low_headroom_fraction = 0.10;  // Shrink when memory.max - memory.current falls below this
+            double shrink_step = 0.25;            // Fraction of the budget dropped per shrink
+            double grow_step = 0.10;              // Fraction of the budget added per grow
+            std::chrono::milliseconds interval{2000};
+            std::string cgroup_dir;               // Empty: discovered from /proc/self/cgroup
+            std::string pressure_path = "/proc/pressure/memory";
+        };
+
+        struct Sample
+        {
+            bool has_limit = false;
+            size_t limit_bytes = 0;
+            size_t usage_bytes = 0;
+            bool has_pressure = false;
+            double some_avg10 = 0;
+        };
+
+    private:
+        LRUFileCache& cache;
+        Config config;
+        std::thread monitor_thread;
+        std::atomic<bool> running;
+        std::mutex wait_mutex;
+        std::condition_variable wake;
+
+    public:
+        MemoryPressureMonitor(LRUFileCache& cache, Config config);
+        ~MemoryPressureMonitor();
+
+        MemoryPressureMonitor(const MemoryPressureMonitor&) = delete;
+        MemoryPressureMonitor& operator=(const MemoryPressureMonitor&) = delete;
+
+        bool start();
+        void stop();
+        bool isRunning() const { return running.load(); }
+
+        // One sample-and-resize step; returns the cache budget afterwards
+        size_t adjust();
+
+        Sample readSample() const;
+        size_t targetCapacity(const Sample& sample, size_t current_capacity) const;
+
+    private:
+        void monitorLoop();
+        static std::string discoverCgroupDir();
+};
+
+#endif // MEMORY_PRESSURE_MONITOR_H
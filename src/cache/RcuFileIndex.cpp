@@ -0,0 +1,266 @@
+#include "RcuFileIndex.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+    constexpr size_t kInitialBuckets = 64;
+    constexpr size_t kReclaimBatch = 64;
+}
+
+EpochDomain& EpochDomain::instance() {
+    // Never destroyed: retired objects may be reclaimed during static destruction
+    static EpochDomain* domain = new EpochDomain();
+    return *domain;
+}
+
+EpochDomain::ReaderSlot* EpochDomain::localSlot() {
+    struct Registration
+    {
+        ReaderSlot* slot = nullptr;
+        ~Registration() {
+            if (slot) {
+                slot->epoch.store(0, std::memory_order_release);
+                slot->in_use.store(false, std::memory_order_release);
+            }
+        }
+    };
+    thread_local Registration registration;
+
+    if (!registration.slot) {
+        for (auto& reader : readers) {
+            bool expected = false;
+            if (!reader.in_use.load(std::memory_order_relaxed) &&
+                reader.in_use.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                registration.slot = &reader;
+                break;
+            }
+        }
+    }
+    return registration.slot;
+}
+
+bool EpochDomain::enter() {
+    ReaderSlot* slot = localSlot();
+    if (!slot) {
+        return false;
+    }
+
+    // Publish the epoch, then make sure it is still current: a writer that
+    // scanned the slots before our store became visible has bumped the epoch
+    uint64_t epoch = global_epoch.load(std::memory_order_seq_cst);
+    while (true) {
+        slot->epoch.store(epoch, std::memory_order_seq_cst);
+        uint64_t current = global_epoch.load(std::memory_order_seq_cst);
+        if (current == epoch) {
+            return true;
+        }
+        epoch = current;
+    }
+}
+
+void EpochDomain::exit() {
+    if (ReaderSlot* slot = localSlot()) {
+        slot->epoch.store(0, std::memory_order_release);
+    }
+}
+
+void EpochDomain::retire(void* object, void (*deleter)(void*)) {
+    size_t pending;
+    {
+        std::lock_guard<std::mutex> lock(retired_mutex);
+        retired.push_back({global_epoch.fetch_add(1, std::memory_order_seq_cst), object, deleter});
+        pending = retired.size();
+    }
+    if (pending >= kReclaimBatch) {
+        reclaim();
+    }
+}
+
+size_t EpochDomain::reclaim() {
+    uint64_t oldest_active = std::numeric_limits<uint64_t>::max();
+    for (const auto& reader : readers) {
+        uint64_t epoch = reader.epoch.load(std::memory_order_seq_cst);
+        if (epoch != 0) {
+            oldest_active = std::min(oldest_active, epoch);
+        }
+    }
+
+    std::vector<Retired> reclaimable;
+    {
+        std::lock_guard<std::mutex> lock(retired_mutex);
+        auto still_visible = std::partition(retired.begin(), retired.end(),
+            [&](const Retired& item) { return item.epoch >= oldest_active; });
+        reclaimable.assign(still_visible, retired.end());
+        retired.erase(still_visible, retired.end());
+    }
+
+    for (const auto& item : reclaimable) {
+        item.deleter(item.object);
+    }
+    return reclaimable.size();
+}
+
+size_t EpochDomain::pendingRetired() const {
+    std::lock_guard<std::mutex> lock(retired_mutex);
+    return retired.size();
+}
+
+RcuFileIndex::Table::Table(size_t bucket_count)
+    : mask(bucket_count - 1), buckets(new std::atomic<Node*>[bucket_count]) {
+    for (size_t i = 0; i < bucket_count; i++) {
+        buckets[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+RcuFileIndex::RcuFileIndex() : table(new Table(kInitialBuckets)), count(0) {
+}
+
+RcuFileIndex::~RcuFileIndex() {
+    // No reader may use the index any more; free it directly
+    Table* current = table.load(std::memory_order_relaxed);
+    for (size_t i = 0; i <= current->mask; i++) {
+        Node* node = current->buckets[i].load(std::memory_order_relaxed);
+        while (node) {
+            Node* next = node->next.load(std::memory_order_relaxed);
+            delete node;
+            node = next;
+        }
+    }
+    delete current;
+}
+
+bool RcuFileIndex::lookup(const std::string& key, uint64_t hash, LookupResult& result,
+                          bool mark_referenced) const {
+    const Table* current = table.load(std::memory_order_acquire);
+    for (const Node* node = current->buckets[hash & current->mask].load(std::memory_order_acquire);
+         node; node = node->next.load(std::memory_order_acquire)) {
+        if (node->hash != hash || node->key != key) {
+            continue;
+        }
+        // Only write the reference bit when it changes, to keep the line shared
+        if (mark_referenced && !node->referenced.load(std::memory_order_relaxed)) {
+            node->referenced.store(1, std::memory_order_relaxed);
+        }
+        result.file = node->file;
+        result.validated = node->validated.load(std::memory_order_acquire);
+        return true;
+    }
+    return false;
+}
+
+void RcuFileIndex::insert(const std::string& key, uint64_t hash, SlotId slot,
+                          std::shared_ptr<const CachedFile> file, bool validated) {
+    Table* current = table.load(std::memory_order_relaxed);
+    if ((count + 1) * 4 > (current->mask + 1) * 3) {
+        grow();
+        current = table.load(std::memory_order_relaxed);
+    }
+
+    Node* node = new Node();
+    node->key = key;
+    node->hash = hash;
+    node->slot = slot;
+    node->file = std::move(file);
+    node->validated.store(validated, std::memory_order_relaxed);
+
+    std::atomic<Node*>& bucket = current->buckets[hash & current->mask];
+    node->next.store(bucket.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    bucket.store(node, std::memory_order_release);
+    count++;
+
+    if (slot >= node_of_slot.size()) {
+        node_of_slot.resize(std::max<size_t>(slot + 1, node_of_slot.size() * 2), nullptr);
+    }
+    node_of_slot[slot] = node;
+}
+
+void RcuFileIndex::erase(const std::string& key, uint64_t hash) {
+    Table* current = table.load(std::memory_order_relaxed);
+    std::atomic<Node*>* link = &current->buckets[hash & current->mask];
+    for (Node* node = link->load(std::memory_order_relaxed); node;
+         link = &node->next, node = link->load(std::memory_order_relaxed)) {
+        if (node->hash == hash && node->key == key) {
+            // Readers standing on `node` still find its successor
+            link->store(node->next.load(std::memory_order_relaxed), std::memory_order_release);
+            node_of_slot[node->slot] = nullptr;
+            count--;
+            retireNode(node);
+            return;
+        }
+    }
+}
+
+void RcuFileIndex::setValidated(SlotId slot, bool validated) {
+    if (slot < node_of_slot.size() && node_of_slot[slot]) {
+        node_of_slot[slot]->validated.store(validated, std::memory_order_release);
+    }
+}
+
+void RcuFileIndex::clear() {
+    Table* old_table = table.exchange(new Table(kInitialBuckets), std::memory_order_acq_rel);
+    for (size_t i = 0; i <= old_table->mask; i++) {
+        for (Node* node = old_table->buckets[i].load(std::memory_order_relaxed); node; ) {
+            Node* next = node->next.load(std::memory_order_relaxed);
+            retireNode(node);
+            node = next;
+        }
+    }
+    EpochDomain::instance().retire(old_table, &RcuFileIndex::deleteTable);
+    node_of_slot.clear();
+    count = 0;
+}
+
+bool RcuFileIndex::testAndClearReferenced(SlotId slot) {
+    if (slot >= node_of_slot.size() || !node_of_slot[slot]) {
+        return false;
+    }
+    return node_of_slot[slot]->referenced.exchange(0, std::memory_order_relaxed) != 0;
+}
+
+void RcuFileIndex::grow() {
+    // Nodes cannot move between chains while readers walk them, so the new
+    // table gets copies and the old generation is retired as a whole
+    Table* old_table = table.load(std::memory_order_relaxed);
+    Table* new_table = new Table((old_table->mask + 1) * 2);
+
+    for (size_t i = 0; i <= old_table->mask; i++) {
+        for (Node* node = old_table->buckets[i].load(std::memory_order_relaxed); node;
+             node = node->next.load(std::memory_order_relaxed)) {
+            Node* copy = new Node();
+            copy->key = node->key;
+            copy->hash = node->hash;
+            copy->slot = node->slot;
+            copy->file = node->file;
+            copy->referenced.store(node->referenced.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            copy->validated.store(node->validated.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+            std::atomic<Node*>& bucket = new_table->buckets[copy->hash & new_table->mask];
+            copy->next.store(bucket.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            bucket.store(copy, std::memory_order_relaxed);
+            node_of_slot[copy->slot] = copy;
+        }
+    }
+
+    table.store(new_table, std::memory_order_release);
+
+    for (size_t i = 0; i <= old_table->mask; i++) {
+        for (Node* node = old_table->buckets[i].load(std::memory_order_relaxed); node; ) {
+            Node* next = node->next.load(std::memory_order_relaxed);
+            retireNode(node);
+            node = next;
+        }
+    }
+    EpochDomain::instance().retire(old_table, &RcuFileIndex::deleteTable);
+}
+
+void RcuFileIndex::retireNode(Node* node) {
+    EpochDomain::instance().retire(node, &RcuFileIndex::deleteNode);
+}
+
+void RcuFileIndex::deleteNode(void* node) {
+    delete static_cast<Node*>(node);
+}
+
+void RcuFileIndex::deleteTable(void* table) {
+    delete static_cast<Table*>(table);
+}
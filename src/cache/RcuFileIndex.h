@@ -0,0 +1,146 @@
+#ifndef RCU_FILE_INDEX_H
+#define RCU_FILE_INDEX_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+#include "FlatIndex.h"
+
+struct CachedFile;
+
+// Epoch-based reclamation for lock-free readers.
+//
+// Readers publish the global epoch they entered in a per-thread,
+// cache-line-padded slot for the duration of a lookup. Writers retire
+// unlinked objects tagged with the current epoch and bump it; an object is
+// freed once every active reader has entered a later epoch, i.e. none can
+// still hold a pointer to it.
+class EpochDomain
+{
+    public:
+        static constexpr size_t kMaxReaders = 1024;
+
+        static EpochDomain& instance();
+
+        // Returns false when every reader slot is taken; the caller must then
+        // use a locked path instead
+        bool enter();
+        void exit();
+
+        void retire(void* object, void (*deleter)(void*));
+
+        // Frees what no reader can reach any more; returns the number freed
+        size_t reclaim();
+
+        size_t pendingRetired() const;
+
+    private:
+        struct alignas(64) ReaderSlot
+        {
+            std::atomic<uint64_t> epoch{0}; // 0: not reading
+            std::atomic<bool> in_use{false};
+        };
+
+        struct Retired
+        {
+            uint64_t epoch;
+            void* object;
+            void (*deleter)(void*);
+        };
+
+        alignas(64) std::atomic<uint64_t> global_epoch{1};
+        ReaderSlot readers[kMaxReaders];
+
+        mutable std::mutex retired_mutex;
+        std::vector<Retired> retired;
+
+        EpochDomain() = default;
+        ReaderSlot* localSlot();
+};
+
+// RAII read-side critical section
+class EpochGuard
+{
+    private:
+        bool active;
+
+    public:
+        EpochGuard() : active(EpochDomain::instance().enter()) {}
+        ~EpochGuard() { if (active) EpochDomain::instance().exit(); }
+        EpochGuard(const EpochGuard&) = delete;
+        EpochGuard& operator=(const EpochGuard&) = delete;
+
+        bool entered() const { return active; }
+};
+
+// Hash table from file path to cached file whose lookups take no lock.
+//
+// Buckets are singly linked chains of immutable nodes published with release
+// stores; the bucket array itself is swapped atomically when it grows, with
+// the old array and nodes retired through EpochDomain. Each node carries a
+// CLOCK reference bit that readers set on a hit, so the eviction policy gets
+// approximate recency without readers writing to any shared structure other
+// than the node they found. All mutations must be serialized by the caller.
+class RcuFileIndex
+{
+    public:
+        struct LookupResult
+        {
+            std::shared_ptr<const CachedFile> file;
+            bool validated = true;
+        };
+
+        RcuFileIndex();
+        ~RcuFileIndex();
+
+        RcuFileIndex(const RcuFileIndex&) = delete;
+        RcuFileIndex& operator=(const RcuFileIndex&) = delete;
+
+        // Lock-free; the caller must be inside an EpochGuard
+        bool lookup(const std::string& key, uint64_t hash, LookupResult& result, bool mark_referenced) const;
+
+        // Writer side, serialized by the caller
+        void insert(const std::string& key, uint64_t hash, SlotId slot,
+                    std::shared_ptr<const CachedFile> file, bool validated);
+        void erase(const std::string& key, uint64_t hash);
+        void setValidated(SlotId slot, bool validated);
+        void clear();
+
+        // CLOCK support for the eviction policy: returns the reference bit of
+        // a slot and clears it
+        bool testAndClearReferenced(SlotId slot);
+
+    private:
+        struct Node
+        {
+            std::string key;
+            uint64_t hash;
+            SlotId slot;
+            std::shared_ptr<const CachedFile> file;
+            std::atomic<Node*> next{nullptr};
+            mutable std::atomic<uint8_t> referenced{0};
+            std::atomic<bool> validated{true};
+        };
+
+        struct Table
+        {
+            size_t mask;
+            std::unique_ptr<std::atomic<Node*>[]> buckets;
+
+            explicit Table(size_t bucket_count);
+        };
+
+        std::atomic<Table*> table;
+        size_t count;
+        std::vector<Node*> node_of_slot; // Writer-side view for CLOCK and validation
+
+        void grow();
+        void retireNode(Node* node);
+        static void deleteNode(void* node);
+        static void deleteTable(void* table);
+};
+
+#endif // RCU_FILE_INDEX_H
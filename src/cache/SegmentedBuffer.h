@@ -0,0 +1,225 @@
+#ifndef SEGMENTED_BUFFER_H
+#define SEGMENTED_BUFFER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <ostream>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <sys/uio.h>
+#include <unistd.h>
+#include "SlabAllocator.h"
+
+// A body stored as a chain of slab blocks of at most kSegmentBytes each.
+//
+// No body ever needs one large contiguous allocation: every segment comes
+// from a slab size class, and only the last one may be shorter than
+// kSegmentBytes. Segments are never moved once written, so a response can
+// hand them to writev() in place, starting at any byte offset.
+class SegmentedBuffer
+{
+    public:
+        static constexpr size_t kSegmentBytes = SlabAllocator::kMaxSlabBlockBytes;
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+    private:
+        struct Segment
+        {
+            char* data;
+            size_t size;
+            size_t capacity;
+        };
+
+        std::vector<Segment> segments;
+        size_t total_bytes = 0;
+
+    public:
+        SegmentedBuffer() = default;
+
+        explicit SegmentedBuffer(std::string_view data)
+        {
+            append(data);
+        }
+
+        SegmentedBuffer(const SegmentedBuffer& other)
+        {
+            segments.reserve(other.segments.size());
+            for (const auto& segment : other.segments) {
+                append(std::string_view(segment.data, segment.size));
+            }
+        }
+
+        SegmentedBuffer(SegmentedBuffer&& other) noexcept
+            : segments(std::move(other.segments)), total_bytes(other.total_bytes)
+        {
+            other.segments.clear();
+            other.total_bytes = 0;
+        }
+
+        SegmentedBuffer& operator=(SegmentedBuffer&& other) noexcept
+        {
+            if (this != &other) {
+                release();
+                segments = std::move(other.segments);
+                total_bytes = other.total_bytes;
+                other.segments.clear();
+                other.total_bytes = 0;
+            }
+            return *this;
+        }
+
+        SegmentedBuffer& operator=(const SegmentedBuffer&) = delete;
+
+        ~SegmentedBuffer()
+        {
+            release();
+        }
+
+        size_t size() const { return total_bytes; }
+        bool empty() const { return total_bytes == 0; }
+        size_t segmentCount() const { return segments.size(); }
+
+        std::string_view segment(size_t index) const
+        {
+            return std::string_view(segments[index].data, segments[index].size);
+        }
+
+        // Copy `data` to the end, topping up the last segment first
+        void append(std::string_view data)
+        {
+            while (!data.empty()) {
+                Segment& tail = writableTail(data.size());
+                size_t count = std::min(tail.capacity - tail.size, data.size());
+                std::memcpy(tail.data + tail.size, data.data(), count);
+                tail.size += count;
+                total_bytes += count;
+                data.remove_prefix(count);
+            }
+        }
+
+        // Read up to `length` bytes from `fd` straight into segments, without
+        // an intermediate copy. Stops early at end of file; returns false on
+        // a read error.
+        bool readFrom(int fd, size_t length)
+        {
+            while (length > 0) {
+                Segment& tail = writableTail(length);
+                size_t wanted = std::min(tail.capacity - tail.size, length);
+                ssize_t got = ::read(fd, tail.data + tail.size, wanted);
+                if (got < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    return false;
+                }
+                if (got == 0) {
+                    break;
+                }
+                tail.size += got;
+                total_bytes += got;
+                length -= got;
+            }
+            return true;
+        }
+
+        // Append iovecs covering bytes [offset, offset + length)
+        template<class IovecVector>
+        void appendIovecs(IovecVector& out, size_t offset = 0, size_t length = npos) const
+        {
+            for (const auto& segment : segments) {
+                if (length == 0) {
+                    break;
+                }
+                if (offset >= segment.size) {
+                    offset -= segment.size;
+                    continue;
+                }
+                size_t count = std::min(segment.size - offset, length);
+                out.push_back({segment.data + offset, count});
+                offset = 0;
+                if (length != npos) {
+                    length -= count;
+                }
+            }
+        }
+
+        // Slab blocks plus the segment table
+        size_t memoryBytes() const
+        {
+            size_t bytes = segments.capacity() * sizeof(Segment);
+            for (const auto& segment : segments) {
+                bytes += SlabAllocator::blockSizeFor(segment.capacity);
+            }
+            return bytes;
+        }
+
+        // memoryBytes() of a body of `bytes` bytes stored in exactly sized segments
+        static size_t memoryBytesFor(size_t bytes)
+        {
+            size_t full = bytes / kSegmentBytes;
+            size_t tail = bytes % kSegmentBytes;
+            return full * SlabAllocator::blockSizeFor(kSegmentBytes) + SlabAllocator::blockSizeFor(tail) +
+                   (full + (tail ? 1 : 0)) * sizeof(Segment);
+        }
+
+        std::string toString() const
+        {
+            std::string result;
+            result.reserve(total_bytes);
+            for (const auto& segment : segments) {
+                result.append(segment.data, segment.size);
+            }
+            return result;
+        }
+
+        friend bool operator==(const SegmentedBuffer& buffer, std::string_view text)
+        {
+            if (buffer.total_bytes != text.size()) {
+                return false;
+            }
+            for (const auto& segment : buffer.segments) {
+                if (std::memcmp(segment.data, text.data(), segment.size) != 0) {
+                    return false;
+                }
+                text.remove_prefix(segment.size);
+            }
+            return true;
+        }
+
+        friend bool operator!=(const SegmentedBuffer& buffer, std::string_view text)
+        {
+            return !(buffer == text);
+        }
+
+        friend std::ostream& operator<<(std::ostream& out, const SegmentedBuffer& buffer)
+        {
+            for (const auto& segment : buffer.segments) {
+                out.write(segment.data, segment.size);
+            }
+            return out;
+        }
+
+    private:
+        // Last segment if it has room, else a new one sized for up to `pending` bytes
+        Segment& writableTail(size_t pending)
+        {
+            if (segments.empty() || segments.back().size == segments.back().capacity) {
+                size_t capacity = std::min(kSegmentBytes, pending);
+                segments.push_back({SlabAllocator::instance().allocate(capacity), 0, capacity});
+            }
+            return segments.back();
+        }
+
+        void release()
+        {
+            for (const auto& segment : segments) {
+                SlabAllocator::instance().deallocate(segment.data, segment.capacity);
+            }
+            segments.clear();
+            total_bytes = 0;
+        }
+};
+
+#endif // SEGMENTED_BUFFER_H
@@ -0,0 +1,290 @@
+#include "SlabAllocator.h"
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <new>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+    constexpr size_t kPageBytes = 4096;
+
+    // Blocks this large are handed back to the kernel when freed
+    constexpr size_t kReleaseOnFreeBytes = 64 * 1024;
+
+    size_t roundUp(size_t bytes, size_t multiple) {
+        return (bytes + multiple - 1) / multiple * multiple;
+    }
+}
+
+SlabAllocator& SlabAllocator::instance() {
+    // Never destroyed: cached files owned by other singletons may still be
+    // released during static destruction
+    static SlabAllocator* allocator = new SlabAllocator();
+    return *allocator;
+}
+
+SlabAllocator::SlabAllocator() {
+    for (size_t block_size : classSizes()) {
+        auto size_class = std::make_unique<SizeClass>();
+        size_class->block_size = block_size;
+        classes.push_back(std::move(size_class));
+    }
+}
+
+const std::vector<size_t>& SlabAllocator::classSizes() {
+    // 64, 80, 96, 112, 128, 160, ... : four classes per power of two
+    static const std::vector<size_t> sizes = [] {
+        std::vector<size_t> result;
+        for (size_t base = kMinBlockBytes; base <= kMaxSlabBlockBytes; base *= 2) {
+            for (size_t step = 0; step < 4; step++) {
+                size_t size = base + step * (base / 4);
+                if (size <= kMaxSlabBlockBytes) {
+                    result.push_back(size);
+                }
+            }
+        }
+        return result;
+    }();
+    return sizes;
+}
+
+size_t SlabAllocator::classIndexFor(size_t bytes) {
+    const auto& sizes = classSizes();
+    return std::lower_bound(sizes.begin(), sizes.end(), bytes) - sizes.begin();
+}
+
+size_t SlabAllocator::blockSizeFor(size_t bytes) {
+    if (bytes == 0) {
+        return 0;
+    }
+    if (bytes > kMaxSlabBlockBytes) {
+        return roundUp(bytes, kPageBytes);
+    }
+    return classSizes()[classIndexFor(bytes)];
+}
+
+void SlabAllocator::setHugePageMode(HugePageMode mode) {
+    huge_page_mode.store(mode, std::memory_order_relaxed);
+}
+
+HugePageMode SlabAllocator::hugePageMode() const {
+    return huge_page_mode.load(std::memory_order_relaxed);
+}
+
+char* SlabAllocator::allocate(size_t bytes) {
+    if (bytes == 0) {
+        return nullptr;
+    }
+    if (bytes > kMaxSlabBlockBytes) {
+        return mapLarge(bytes);
+    }
+
+    size_t class_index = classIndexFor(bytes);
+    SizeClass& size_class = *classes[class_index];
+    char* data;
+    {
+        std::lock_guard<std::mutex> lock(size_class.mutex);
+        if (size_class.partial.empty()) {
+            addPartial(size_class, mapArena(class_index));
+        }
+
+        Arena* arena = size_class.partial.back();
+        uint32_t block;
+        if (!arena->free_blocks.empty()) {
+            block = arena->free_blocks.back();
+            arena->free_blocks.pop_back();
+        } else {
+            block = static_cast<uint32_t>(arena->bump++);
+        }
+        if (++arena->live == arena->block_count) {
+            removePartial(size_class, arena);
+        }
+        data = arena->base + block * size_class.block_size;
+    }
+
+    payload_bytes.add(bytes);
+    allocated_bytes.add(size_class.block_size);
+    return data;
+}
+
+void SlabAllocator::deallocate(char* data, size_t bytes) {
+    if (!data) {
+        return;
+    }
+
+    if (bytes > kMaxSlabBlockBytes) {
+        size_t length = blockSizeFor(bytes);
+        munmap(data, length);
+
+        payload_bytes.subtract(bytes);
+        allocated_bytes.subtract(length);
+        mapped_bytes.fetch_sub(length, std::memory_order_relaxed);
+        large_mappings.fetch_sub(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Arena* arena;
+    {
+        std::shared_lock<std::shared_mutex> lock(arenas_mutex);
+        arena = arenas.at(reinterpret_cast<uintptr_t>(data) & ~(kArenaBytes - 1)).get();
+    }
+
+    // The block being freed keeps the arena mapped until we are done here
+    SizeClass& size_class = *classes[arena->class_index];
+    size_t block_size = size_class.block_size;
+    {
+        std::lock_guard<std::mutex> lock(size_class.mutex);
+        if (!arena->huge && block_size >= kReleaseOnFreeBytes) {
+            madvise(data, block_size, MADV_DONTNEED);
+        }
+
+        arena->free_blocks.push_back(static_cast<uint32_t>((data - arena->base) / block_size));
+        if (arena->partial_index == kNotPartial) {
+            addPartial(size_class, arena);
+        }
+        if (--arena->live == 0) {
+            removePartial(size_class, arena);
+            unmapArena(arena);
+        }
+    }
+
+    payload_bytes.subtract(bytes);
+    allocated_bytes.subtract(block_size);
+}
+
+SlabAllocator::Arena* SlabAllocator::mapArena(size_t class_index) {
+    HugePageMode mode = hugePageMode();
+    void* memory = MAP_FAILED;
+    bool huge = false;
+
+    if (mode == HugePageMode::HugeTLB) {
+        memory = mmap(nullptr, kArenaBytes, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        huge = memory != MAP_FAILED;
+        if (!huge) {
+            static std::atomic<bool> warned{false};
+            if (!warned.exchange(true, std::memory_order_relaxed)) {
+                std::cout << "[SlabAllocator] MAP_HUGETLB failed (no huge pages reserved?), "
+                          << "using regular pages" << std::endl;
+            }
+        }
+    }
+
+    if (memory == MAP_FAILED) {
+        // Over-map and trim so the arena is aligned to its own size
+        void* raw = mmap(nullptr, 2 * kArenaBytes, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+        uintptr_t aligned = roundUp(start, kArenaBytes);
+        if (aligned > start) {
+            munmap(raw, aligned - start);
+        }
+        size_t tail = start + 2 * kArenaBytes - (aligned + kArenaBytes);
+        if (tail > 0) {
+            munmap(reinterpret_cast<void*>(aligned + kArenaBytes), tail);
+        }
+        memory = reinterpret_cast<void*>(aligned);
+
+        if (mode == HugePageMode::Transparent) {
+            huge = madvise(memory, kArenaBytes, MADV_HUGEPAGE) == 0;
+        }
+    }
+
+    auto arena = std::make_unique<Arena>();
+    arena->base = static_cast<char*>(memory);
+    arena->class_index = class_index;
+    arena->block_count = kArenaBytes / classes[class_index]->block_size;
+    arena->bump = 0;
+    arena->live = 0;
+    arena->partial_index = kNotPartial;
+    arena->huge = huge;
+
+    Arena* result = arena.get();
+    {
+        std::unique_lock<std::shared_mutex> lock(arenas_mutex);
+        arenas.emplace(reinterpret_cast<uintptr_t>(memory), std::move(arena));
+    }
+
+    mapped_bytes.fetch_add(kArenaBytes, std::memory_order_relaxed);
+    arena_count.fetch_add(1, std::memory_order_relaxed);
+    huge_page_arenas.fetch_add(huge ? 1 : 0, std::memory_order_relaxed);
+    return result;
+}
+
+void SlabAllocator::unmapArena(Arena* arena) {
+    // Unregistered before the range goes back to the kernel: another class
+    // mapping an arena at the same address must not find this entry there
+    bool huge = arena->huge;
+    char* base = arena->base;
+    {
+        std::unique_lock<std::shared_mutex> lock(arenas_mutex);
+        arenas.erase(reinterpret_cast<uintptr_t>(base));
+    }
+    munmap(base, kArenaBytes);
+
+    mapped_bytes.fetch_sub(kArenaBytes, std::memory_order_relaxed);
+    arena_count.fetch_sub(1, std::memory_order_relaxed);
+    huge_page_arenas.fetch_sub(huge ? 1 : 0, std::memory_order_relaxed);
+}
+
+char* SlabAllocator::mapLarge(size_t bytes) {
+    size_t length = blockSizeFor(bytes);
+    void* memory = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    if (length >= kArenaBytes && hugePageMode() != HugePageMode::Off) {
+        madvise(memory, length, MADV_HUGEPAGE);
+    }
+
+    payload_bytes.add(bytes);
+    allocated_bytes.add(length);
+    mapped_bytes.fetch_add(length, std::memory_order_relaxed);
+    large_mappings.fetch_add(1, std::memory_order_relaxed);
+    return static_cast<char*>(memory);
+}
+
+void SlabAllocator::addPartial(SizeClass& size_class, Arena* arena) {
+    arena->partial_index = size_class.partial.size();
+    size_class.partial.push_back(arena);
+}
+
+void SlabAllocator::removePartial(SizeClass& size_class, Arena* arena) {
+    size_t index = arena->partial_index;
+    size_class.partial[index] = size_class.partial.back();
+    size_class.partial[index]->partial_index = index;
+    size_class.partial.pop_back();
+    arena->partial_index = kNotPartial;
+}
+
+SlabAllocator::Stats SlabAllocator::getStats() const {
+    // A read racing an allocation on one stripe and its free on another can
+    // see the free alone; report that as zero rather than a wrapped value
+    auto gauge = [](const StripedCounter& counter) {
+        size_t value = counter.load();
+        return static_cast<std::ptrdiff_t>(value) < 0 ? 0 : value;
+    };
+
+    Stats stats;
+    stats.payload_bytes = gauge(payload_bytes);
+    stats.allocated_bytes = gauge(allocated_bytes);
+    stats.mapped_bytes = mapped_bytes.load(std::memory_order_relaxed);
+    stats.arenas = arena_count.load(std::memory_order_relaxed);
+    stats.huge_page_arenas = huge_page_arenas.load(std::memory_order_relaxed);
+    stats.large_mappings = large_mappings.load(std::memory_order_relaxed);
+    return stats;
+}
+
+size_t SlabAllocator::processResidentBytes() {
+    std::ifstream statm("/proc/self/statm");
+    size_t total_pages = 0;
+    size_t resident_pages = 0;
+    if (!(statm >> total_pages >> resident_pages)) {
+        return 0;
+    }
+    return resident_pages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
@@ -0,0 +1,117 @@
+#ifndef SLAB_ALLOCATOR_H
+#define SLAB_ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include "StripedCounter.h"
+
+enum class HugePageMode
+{
+    Off,         // Regular 4KB pages
+    Transparent, // madvise(MADV_HUGEPAGE) on every arena
+    HugeTLB      // MAP_HUGETLB arenas, falling back to regular pages if none are reserved
+};
+
+// Size-classed slab storage for cached file bodies.
+//
+// Small and medium bodies are carved from 2MB arenas, one size class per
+// arena, with four classes per power of two so internal waste stays under
+// ~20%. Arenas are 2MB aligned (a free finds its arena by masking the address)
+// and are unmapped as soon as they become empty, so churn cannot strand
+// memory the way a general-purpose heap does. Bodies above kMaxSlabBlockBytes
+// get their own page-rounded mapping.
+class SlabAllocator
+{
+    public:
+        static constexpr size_t kArenaBytes = 2 * 1024 * 1024;
+        static constexpr size_t kMinBlockBytes = 64;
+        static constexpr size_t kMaxSlabBlockBytes = 256 * 1024;
+
+        struct Stats
+        {
+            size_t payload_bytes = 0;    // Bytes callers asked for
+            size_t allocated_bytes = 0;  // Bytes of the blocks handed out
+            size_t mapped_bytes = 0;     // Arena and large mappings
+            size_t arenas = 0;
+            size_t huge_page_arenas = 0;
+            size_t large_mappings = 0;
+        };
+
+        static SlabAllocator& instance();
+
+        // Applies to arenas mapped after the call
+        void setHugePageMode(HugePageMode mode);
+        HugePageMode hugePageMode() const;
+
+        // Returns nullptr for zero bytes; throws std::bad_alloc when mapping fails
+        char* allocate(size_t bytes);
+        void deallocate(char* data, size_t bytes);
+
+        // Bytes actually reserved for a body of `bytes` bytes
+        static size_t blockSizeFor(size_t bytes);
+
+        Stats getStats() const;
+
+        // Resident set size of the whole process, from /proc/self/statm
+        static size_t processResidentBytes();
+
+    private:
+        struct Arena
+        {
+            char* base;
+            size_t class_index;
+            size_t block_count;
+            size_t bump;                      // Blocks never handed out start here
+            std::vector<uint32_t> free_blocks;
+            size_t live;
+            size_t partial_index;             // Position in SizeClass::partial, or npos
+            bool huge;
+        };
+
+        struct SizeClass
+        {
+            size_t block_size;
+            std::vector<Arena*> partial;      // Arenas with at least one free block
+            std::mutex mutex;
+        };
+
+        static constexpr size_t kNotPartial = static_cast<size_t>(-1);
+
+        std::vector<std::unique_ptr<SizeClass>> classes;
+
+        // Arena lookup by 2MB-aligned base address
+        std::unordered_map<uintptr_t, std::unique_ptr<Arena>> arenas;
+        mutable std::shared_mutex arenas_mutex;
+
+        // Byte counts change on every allocation, so they are striped; the
+        // mapping counts change only with mmap/munmap
+        StripedCounter payload_bytes;
+        StripedCounter allocated_bytes;
+        std::atomic<size_t> mapped_bytes{0};
+        std::atomic<size_t> arena_count{0};
+        std::atomic<size_t> huge_page_arenas{0};
+        std::atomic<size_t> large_mappings{0};
+        std::atomic<HugePageMode> huge_page_mode{HugePageMode::Off};
+
+        SlabAllocator();
+        SlabAllocator(const SlabAllocator&) = delete;
+        SlabAllocator& operator=(const SlabAllocator&) = delete;
+
+        static const std::vector<size_t>& classSizes();
+        static size_t classIndexFor(size_t bytes);
+
+        Arena* mapArena(size_t class_index);
+        void unmapArena(Arena* arena);
+        char* mapLarge(size_t bytes);
+
+        static void addPartial(SizeClass& size_class, Arena* arena);
+        static void removePartial(SizeClass& size_class, Arena* arena);
+};
+
+#endif // SLAB_ALLOCATOR_H
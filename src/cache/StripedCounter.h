@@ -0,0 +1,60 @@
+#ifndef STRIPED_COUNTER_H
+#define STRIPED_COUNTER_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// Event counter split across cache-line-padded stripes. Each thread sticks to
+// one stripe, so hot-path increments from different workers do not bounce a
+// shared cache line; reads sum every stripe.
+class StripedCounter
+{
+    private:
+        static constexpr size_t kStripes = 64;
+
+        struct alignas(64) Stripe
+        {
+            std::atomic<size_t> value{0};
+        };
+
+        std::array<Stripe, kStripes> stripes;
+
+        static size_t stripeIndex()
+        {
+            static std::atomic<size_t> next_stripe{0};
+            thread_local size_t index = next_stripe.fetch_add(1, std::memory_order_relaxed) % kStripes;
+            return index;
+        }
+
+    public:
+        void add(size_t amount = 1)
+        {
+            stripes[stripeIndex()].value.fetch_add(amount, std::memory_order_relaxed);
+        }
+
+        // For gauges that go down as well as up. A stripe may wrap below zero
+        // on its own; the sum is still exact once the writers are done.
+        void subtract(size_t amount)
+        {
+            stripes[stripeIndex()].value.fetch_sub(amount, std::memory_order_relaxed);
+        }
+
+        size_t load() const
+        {
+            size_t total = 0;
+            for (const auto& stripe : stripes) {
+                total += stripe.value.load(std::memory_order_relaxed);
+            }
+            return total;
+        }
+
+        void reset()
+        {
+            for (auto& stripe : stripes) {
+                stripe.value.store(0, std::memory_order_relaxed);
+            }
+        }
+};
+
+#endif // STRIPED_COUNTER_H
@@ -0,0 +1,85 @@
+#ifndef TTL_RULES_H
+#define TTL_RULES_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <fnmatch.h>
+
+// Per-path freshness lifetimes for cached files, matched by glob.
+//
+// Meant for content whose changes the file watcher cannot see (e.g. NFS
+// mounts). An entry older than its TTL is still served, and one background
+// revalidation checks the file and reloads it if it changed
+// (stale-while-revalidate). The first matching rule wins; paths without a
+// matching rule never expire. Rules are set up before serving and only read
+// afterwards, so lookups take no lock.
+class TtlRules
+{
+    private:
+        struct Rule
+        {
+            std::string pattern;  // fnmatch(3) glob; '*' also matches '/'
+            std::chrono::milliseconds ttl;
+        };
+
+        std::vector<Rule> rules;
+
+    public:
+        void add(const std::string& pattern, std::chrono::milliseconds ttl)
+        {
+            rules.push_back({pattern, ttl});
+        }
+
+        // One "<glob> <seconds>" rule per line; blank lines and '#' comments
+        // are skipped. Returns false if the file cannot be read or a line is
+        // malformed.
+        bool loadFile(const std::string& path)
+        {
+            std::ifstream in(path);
+            if (!in) {
+                std::cerr << "[TtlRules] Cannot open " << path << std::endl;
+                return false;
+            }
+
+            std::string line;
+            size_t line_number = 0;
+            while (std::getline(in, line)) {
+                line_number++;
+                std::istringstream fields(line);
+                std::string pattern;
+                if (!(fields >> pattern) || pattern[0] == '#') {
+                    continue;
+                }
+                double seconds;
+                if (!(fields >> seconds) || seconds < 0) {
+                    std::cerr << "[TtlRules] " << path << ":" << line_number
+                              << ": expected \"<glob> <seconds>\"" << std::endl;
+                    return false;
+                }
+                add(pattern, std::chrono::milliseconds(static_cast<long long>(seconds * 1000)));
+            }
+
+            std::cout << "[TtlRules] Loaded " << rules.size() << " TTL rules from " << path << std::endl;
+            return true;
+        }
+
+        bool empty() const { return rules.empty(); }
+        size_t size() const { return rules.size(); }
+
+        // Whether an entry for `path` that is `age` old needs revalidation
+        bool expired(const std::string& path, std::chrono::system_clock::duration age) const
+        {
+            for (const auto& rule : rules) {
+                if (fnmatch(rule.pattern.c_str(), path.c_str(), 0) == 0) {
+                    return age > rule.ttl;
+                }
+            }
+            return false;
+        }
+};
+
+#endif // TTL_RULES_H
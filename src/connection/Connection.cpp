@@ -50,15 +50,20 @@ void Connection::incrementRequestCount()
 
 std::string Connection::getStatusString() const {
     std::ostringstream oss;
-    oss << "Connection{socket=" << socket_fd 
-        << ", client=" << client_ip
-        << ", state=" << static_cast<int>(state)
-        << ", requests=" << current_requests << "/" << max_requests
-        << ", keepalive=" << (canContinue() ? "yes" : "no")
-        << "}";
+    oss << *this;
     return oss.str();
 }
 
+// Streams straight to `out`, without building a string (for per-request logs)
+std::ostream& operator<<(std::ostream& out, const Connection& connection) {
+    return out << "Connection{socket=" << connection.socket_fd
+               << ", client=" << connection.client_ip
+               << ", state=" << static_cast<int>(connection.state)
+               << ", requests=" << connection.current_requests << "/" << connection.max_requests
+               << ", keepalive=" << (connection.canContinue() ? "yes" : "no")
+               << "}";
+}
+
 bool Connection::canContinue() const {
     return !should_close.load() && current_requests < max_requests;
 }
@@ -4,6 +4,8 @@
 #include <string>
 #include <chrono>
 #include <atomic>
+#include <ostream>
+#include "RequestArena.h"
 
 enum class ConnectionEndReason {
     Timeout,
@@ -52,6 +54,9 @@ class Connection
         std::chrono::seconds timeout;
 
         std::atomic<bool> should_close;
+
+        // Scratch memory for the request in flight, reset between requests
+        RequestArena arena;
     
     public:
         Connection(int socket, const std::string& ip);
@@ -74,7 +79,7 @@ class Connection
 
         // Getters
         int getSocketFd() const { return socket_fd;}
-        std::string getClientIp() const { return client_ip; }
+        const std::string& getClientIp() const { return client_ip; }
         int getCurrentRequests() const { return current_requests; }
         int getMaxRequests() const { return max_requests; }
         std::chrono::seconds getTimeout() const { return timeout; }
@@ -86,7 +91,10 @@ class Connection
         void setMaxRequests(int max) { max_requests = max; }
         void setTimeout(std::chrono::seconds t) { timeout = t; }
 
+        RequestArena& getArena() { return arena; }
+
         // Status
         std::string getStatusString() const;
+        friend std::ostream& operator<<(std::ostream& out, const Connection& connection);
 };
 #endif // CONNECTION_H
\ No newline at end of file
@@ -0,0 +1,32 @@
+#ifndef REQUEST_ARENA_H
+#define REQUEST_ARENA_H
+
+#include <memory_resource>
+#include <cstddef>
+
+// Bump allocator for everything one request needs: the response head, the
+// iovec list, owning request copies. Memory is never freed piecemeal; reset()
+// between keep-alive requests rewinds to the start of the inline block, so a
+// typical request never reaches the global heap. Bigger requests spill into
+// heap blocks that reset() hands back.
+class RequestArena
+{
+    public:
+        static constexpr size_t kInlineBytes = 16 * 1024;
+
+        RequestArena() : arena(inline_block, sizeof(inline_block), std::pmr::new_delete_resource()) {}
+
+        RequestArena(const RequestArena&) = delete;
+        RequestArena& operator=(const RequestArena&) = delete;
+
+        std::pmr::memory_resource* resource() { return &arena; }
+
+        // Everything allocated from resource() is invalid afterwards
+        void reset() { arena.release(); }
+
+    private:
+        alignas(std::max_align_t) char inline_block[kInlineBytes];
+        std::pmr::monotonic_buffer_resource arena;
+};
+
+#endif // REQUEST_ARENA_H
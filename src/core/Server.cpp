@@ -1,4 +1,5 @@
 #include "Server.h"
+#include "HttpDate.h"
 #include <poll.h>
 #include <fcntl.h>
 #include <algorithm>
@@ -76,6 +77,27 @@ void Server::start() {
     try {
         setupSocket();
         bindSocket();
+
+        // Invalidate cached files when the document root changes on disk
+        file_handler.startWatching();
+
+        // Size the cache from the container's memory before filling it
+        if (adaptive_cache) {
+            memory_monitor = std::make_unique<MemoryPressureMonitor>(
+                FileCacheManager::get_instance(), memory_monitor_config);
+            memory_monitor->start();
+        }
+
+        // Preload the cache before accepting traffic: last run's snapshot
+        // first, then whatever the warm-up still has to load
+        if (!cache_snapshot_path.empty()) {
+            file_handler.restoreCacheSnapshot(cache_snapshot_path);
+        }
+        file_handler.warmCache(*thread_pool, warmup_manifest);
+
+        // The Date header's once-a-second timer
+        HttpDate::start();
+
         startListening();
         
         running = true;
@@ -131,22 +153,21 @@ void Server::handleClient(int client_socket) {
     ssize_t bytes_read = read(client_socket, buffer, sizeof(buffer) - 1);
     
     if (bytes_read > 0) {
-        std::string raw_request(buffer);
         std::cout << "[Server] Received request (" << bytes_read << " bytes)" << std::endl;
         
-        // Parse HTTP request
-        HttpRequest request = HttpParser::parse(raw_request);
+        // Parse HTTP request in place; the view points into buffer
+        HttpRequestView request;
         
-        if (request.isValid()) {
-            std::cout << "[Server] Valid HTTP request parsed:" << std::endl;
-            std::cout << request.toString() << std::endl;
+        if (HttpParser::parse(std::string_view(buffer, bytes_read), request) && request.isValid()) {
+            std::cout << "[Server] Valid HTTP request parsed: " << request.method << " "
+                      << request.path << " " << request.version << std::endl;
             
             try {
                 // Route request and generate response
-                std::string response = routeRequest(request);
+                HttpResponse response = routeRequest(request);
                 
                 // Send response to client
-                send(client_socket, response.c_str(), response.length(), 0);
+                response.writeTo(client_socket);
                 std::cout << "[Server] Response sent successfully" << std::endl;
                 
             } catch (const std::exception& e) {
@@ -191,8 +212,49 @@ void Server::handleConnection(std::unique_ptr<Connection> connection) {
         connection->markForClosing();
     };
 
+    // Bytes received and not yet consumed; a pipelined request stays here
+    // after the one before it is answered
+    std::string pending;
+    pending.reserve(4096);
+    HttpRequestParser parser;
+    HttpRequestView request;
+    HttpBodyDecoder body_decoder;
+
+    // Bodies are decoded from pending, then straight from body_buffer as
+    // they are read, so a large upload never accumulates in memory. The
+    // request views point into pending, which is left untouched until the
+    // response is sent: request_bytes is how much of it the request used,
+    // and whatever followed the body in the last read waits in body_leftover.
+    char body_buffer[16 * 1024];
+    size_t request_bytes = 0;
+    std::string_view body_leftover;
+    ConnectionEndReason body_end_reason = ConnectionEndReason::ClientClosed;
+    auto readBody = [&](HttpBodyHandler* handler) {
+        size_t consumed = 0;
+        HttpBodyDecoder::Status body_status =
+            body_decoder.decode(std::string_view(pending).substr(request_bytes), consumed, handler);
+        request_bytes += consumed;
+        while (body_status == HttpBodyDecoder::Status::NeedMore) {
+            if (!handler && body_decoder.bodyBytes() > kMaxDiscardedBodyBytes) {
+                return HttpBodyDecoder::Status::Error;
+            }
+            ssize_t bytes_read = read(connection->getSocketFd(), body_buffer, sizeof(body_buffer));
+            if (bytes_read <= 0) {
+                if (bytes_read < 0 && errno == EINTR) {
+                    continue;
+                }
+                body_end_reason = bytes_read == 0 ? ConnectionEndReason::ClientClosed :
+                                  (errno == EAGAIN || errno == EWOULDBLOCK) ? ConnectionEndReason::Timeout :
+                                  ConnectionEndReason::ReadError;
+                break;  // Cut short: still NeedMore
+            }
+            body_status = body_decoder.decode(std::string_view(body_buffer, bytes_read), consumed, handler);
+            body_leftover = std::string_view(body_buffer + consumed, bytes_read - consumed);
+        }
+        return body_status;
+    };
+
     while (connection->canContinue()) {
-        char buffer[4096] = {0};
         connection->setState(ConnectionState::READING);
         connection->updateActivity();
 
@@ -205,40 +267,124 @@ void Server::handleConnection(std::unique_ptr<Connection> connection) {
             break;
         }
 
-        // Read request from client (blocking, with timeout)
-        ssize_t bytes_read = read(connection->getSocketFd(), buffer, sizeof(buffer) - 1);
-        if (bytes_read == 0) {
-            terminate(ConnectionEndReason::ClientClosed);
-            break;
-        } else if (bytes_read < 0) {
-            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ETIMEDOUT) {
-                terminate(ConnectionEndReason::Timeout);
-            } else {
-                terminate(ConnectionEndReason::ReadError);
+        // Feed the parser until the request head is complete; each read only
+        // costs the parser the bytes it added
+        connection->getArena().reset();
+        parser.reset();
+        HttpRequestParser::Status status = parser.feed(pending, request);
+        bool read_failed = false;
+        while (status == HttpRequestParser::Status::NeedMore) {
+            char buffer[4096];
+            ssize_t bytes_read = read(connection->getSocketFd(), buffer, sizeof(buffer));
+            if (bytes_read == 0) {
+                terminate(ConnectionEndReason::ClientClosed);
+                read_failed = true;
+                break;
+            } else if (bytes_read < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ETIMEDOUT) {
+                    terminate(ConnectionEndReason::Timeout);
+                } else {
+                    terminate(ConnectionEndReason::ReadError);
+                }
+                read_failed = true;
+                break;
             }
+            pending.append(buffer, bytes_read);
+            status = parser.feed(pending, request);
+        }
+        if (read_failed) {
             break;
         }
+
         connection->setState(ConnectionState::PROCESSING);
         connection->incrementRequestCount();
         connection->updateActivity();
-        std::string raw_request(buffer, bytes_read);
         std::cout << "[Server] Processing request " << connection->getCurrentRequests() 
                   << "/" << connection->getMaxRequests()     
                   << " from " << connection->getClientIp()
-                  << " (" << bytes_read << " bytes)" << std::endl;
+                  << " (" << parser.headerBytes() << " bytes)" << std::endl;
 
-        // Parse HTTP request
-        HttpRequest request = HttpParser::parse(raw_request);
-        if (!request.isValid()) {
+        if (status == HttpRequestParser::Status::Error || !request.isValid()) {
             std::cout << "[Server] Invalid HTTP request" << std::endl;
-            std::string error_response = ResponseGenerator::create400Response();
+            bad_requests.add();
+            std::string error_response;
+            switch (parser.errorStatus()) {
+                case 414: error_response = ResponseGenerator::create414Response(); break;
+                case 431: error_response = ResponseGenerator::create431Response(); break;
+                default: error_response = ResponseGenerator::create400Response(); break;
+            }
+            send(connection->getSocketFd(), error_response.c_str(), error_response.length(), 0);
+            terminate(ConnectionEndReason::BadRequest);
+            break;
+        }
+
+        // A body that can't be framed can't be skipped either
+        request_bytes = parser.headerBytes();
+        body_leftover = std::string_view();
+        std::string_view expect = request.getHeader(HttpHeader::Expect);
+        bool bad_expect = request.hasHeader(HttpHeader::Expect) &&
+                          !HttpHeaderNames::equalsIgnoreCase(expect, "100-continue");
+        if (!body_decoder.start(request) || bad_expect) {
+            std::cout << "[Server] Unusable request body framing" << std::endl;
+            bad_requests.add();
+            std::string error_response = bad_expect ? ResponseGenerator::create417Response() :
+                                         body_decoder.errorStatus() == 501 ? ResponseGenerator::create501Response() :
+                                         ResponseGenerator::create400Response();
             send(connection->getSocketFd(), error_response.c_str(), error_response.length(), 0);
             terminate(ConnectionEndReason::BadRequest);
             break;
         }
         try {
             connection->setState(ConnectionState::WRITING);
-            std::string response = routeRequest(request);
+            // In the arena, like the responses assigned to it, so assigning
+            // one moves its head instead of copying it to the heap
+            HttpResponse response(connection->getArena().resource());
+            bool body_unread = false;  // Bytes of this request remain on the socket
+            std::unique_ptr<HttpBodyHandler> body_handler;
+            bool refused = false;
+            if (upload_handler.handles(request)) {
+                body_handler = upload_handler.begin(request, body_decoder, response);
+                refused = !body_handler;
+            } else if (body_decoder.framing() == HttpBodyDecoder::Framing::ContentLength &&
+                       body_decoder.contentLength() > kMaxDiscardedBodyBytes) {
+                response = ResponseGenerator::create413Response();
+                refused = true;
+            }
+
+            if (refused) {
+                // Answered without reading the body, then closed
+                body_unread = body_decoder.status() == HttpBodyDecoder::Status::NeedMore;
+            } else {
+                // The client waits for a go-ahead only if it hasn't started sending
+                if (!expect.empty() && request.isHttp11() && pending.size() == request_bytes &&
+                    body_decoder.status() == HttpBodyDecoder::Status::NeedMore) {
+                    static constexpr std::string_view kContinue = "HTTP/1.1 100 Continue\r\n\r\n";
+                    send(connection->getSocketFd(), kContinue.data(), kContinue.size(), 0);
+                }
+                HttpBodyDecoder::Status body_status = readBody(body_handler.get());
+                if (body_status == HttpBodyDecoder::Status::Complete) {
+                    response = body_handler ? body_handler->onBodyComplete() :
+                               routeRequest(request, connection->getArena().resource());
+                } else if (body_status == HttpBodyDecoder::Status::NeedMore) {
+                    terminate(body_end_reason);  // Nobody left to answer
+                    break;
+                } else {
+                    body_unread = true;
+                    if (body_decoder.errorStatus() == 400) {
+                        bad_requests.add();
+                        response = ResponseGenerator::create400Response();
+                    } else if (body_handler) {
+                        response = body_handler->onBodyError();
+                    } else {
+                        response = ResponseGenerator::create413Response();
+                    }
+                }
+            }
+            body_handler.reset();  // Partial uploads are gone before the client hears back
+
             bool client_wants_keepalive = request.wantsKeepAlive();
             bool server_can_continue = connection->canContinue();
             int current_load = active_connections.load();
@@ -247,7 +393,8 @@ void Server::handleConnection(std::unique_ptr<Connection> connection) {
             // Final decision
             bool use_keepalive = client_wants_keepalive && 
                                server_can_continue && 
-                               traffic_allows_keepalive;
+                               traffic_allows_keepalive &&
+                               !body_unread;
 
 
            std::cout << "[Server] Keep-alive analysis:\n"
@@ -258,16 +405,22 @@ void Server::handleConnection(std::unique_ptr<Connection> connection) {
                       << "  - Max requests reached: " << (connection->hasReachedMaxRequests() ? "yes" : "no") << std::endl
                       << "  - Final decision: " << (use_keepalive ? "KEEP-ALIVE" : "CLOSE") << std::endl;
             
-            response = addKeepAliveHeaders(response, use_keepalive, connection.get());
-            ssize_t sent = send(connection->getSocketFd(), response.c_str(), response.length(), 0);
+            response.setConnection(use_keepalive, connection->getTimeout().count(), connection->getMaxRequests());
+            ssize_t sent = response.writeTo(connection->getSocketFd());
             if (sent < 0) {
                 terminate(ConnectionEndReason::SendError);
                 break;
             }
+            requests_served.add();
+            response_bytes.add(sent);
+            pending.erase(0, request_bytes);
+            pending.append(body_leftover.data(), body_leftover.size());
             std::cout << "[Server] Response sent (" << sent << " bytes)" << std::endl;
             if (!use_keepalive) {
                 ConnectionEndReason reason;
-                if (connection->hasReachedMaxRequests()) {
+                if (body_unread) {
+                    reason = ConnectionEndReason::BadRequest;
+                } else if (connection->hasReachedMaxRequests()) {
                     reason = ConnectionEndReason::MaxRequests;
                 } else if (!traffic_allows_keepalive) {
                     reason = ConnectionEndReason::KeepAliveNotAllowed;
@@ -278,7 +431,7 @@ void Server::handleConnection(std::unique_ptr<Connection> connection) {
                 break;
             }
             connection->setState(ConnectionState::KEEP_ALIVE);
-            std::cout << "[Server] Connection status: " << connection->getStatusString() << std::endl;
+            std::cout << "[Server] Connection status: " << *connection << std::endl;
             std::cout << "[Server] Waiting for next request (timeout in " 
                       << connection->getTimeout().count() << "s)..." << std::endl;
         } catch (const std::exception& e) {
@@ -300,52 +453,52 @@ void Server::handleConnection(std::unique_ptr<Connection> connection) {
    
 }
 
-std::string Server::addKeepAliveHeaders(const std::string& response, bool keep_alive, const Connection* connection) {
-    // Find the end of headers (empty line)
-    size_t headers_end = response.find("\r\n\r\n");
-    if (headers_end == std::string::npos) {
-        return response;  // Malformed response
+bool Server::setCacheTtlRules(const std::string& rules_path) {
+    TtlRules rules;
+    if (!rules.loadFile(rules_path)) {
+        return false;
     }
-    
-    std::string headers = response.substr(0, headers_end);
-    std::string body = response.substr(headers_end);
-    
-    // Add keep-alive headers
-    if (keep_alive) {
-        headers += "\r\nConnection: keep-alive";
-        headers += "\r\nKeep-Alive: timeout=" + std::to_string(connection->getTimeout().count()) + 
-                   ", max=" + std::to_string(connection->getMaxRequests());
-    } else {
-        headers += "\r\nConnection: close";
-    }
-    
-    return headers + body;
+    file_handler.setTtlRules(std::move(rules));
+    return true;
 }
 
-std::string Server::routeRequest(const HttpRequest& request)
+HttpResponse Server::routeRequest(const HttpRequestView& request, std::pmr::memory_resource* arena)
 {
-    std::string path = request.getPath();
+    // The cache and document index key by std::string; this worker's copy
+    // keeps its capacity, so after the first few requests it never allocates
+    thread_local std::string path;
+    path.assign(request.path);
     std::cout <<"[Server] Routing request to path: " << path << std::endl;  
 
+    // Everything below is read-only; uploads are routed before the body is read
+    switch (request.method_id) {
+        case HttpMethod::Get:
+        case HttpMethod::Head:
+            break;
+        default:
+            std::cout << "[Server] Method not allowed: " << request.method << std::endl;
+            return static_responses.serve(StaticResponses::Page::MethodNotAllowed, request, arena);
+    }
+
     // Try to serve static files for everything else
     if (file_handler.canServeFile(path)) {
         std::cout << "[Server] Serving static file: " << path << std::endl;
-        return file_handler.serveFile(path);
+        return file_handler.serveFile(path, arena, request.method_id == HttpMethod::Head);
     }
 
     if (path == "/about") {
         std::cout << "[Server] Serving about page" << std::endl;
-        return ResponseGenerator::createAboutPageResponse(); 
+        return static_responses.serve(StaticResponses::Page::About, request, arena);
     } 
     else if (path == "/status") {
         std::cout << "[Server] Serving status page" << std::endl;
-        return ResponseGenerator::createStatusPageResponse(port);
+        return static_responses.serve(StaticResponses::Page::Status, request, arena);
     }
 
     
 
     std::cout << "[Server] Path not found: " << path << std::endl;
-    return ResponseGenerator::create404Response();
+    return static_responses.serve(StaticResponses::Page::NotFound, request, arena);
 }
 
 // Add this method to print periodic cache statistics
@@ -357,6 +510,9 @@ void Server::printPeriodicStats() {
     if (std::chrono::duration_cast<std::chrono::seconds>(now - last_stats_time).count() >= 30) {
         std::cout << "\n=== SERVER STATISTICS ===" << std::endl;
         std::cout << "[Server] Active connections: " << active_connections.load() << std::endl;
+        std::cout << "[Server] Requests served: " << requests_served.load()
+                  << " (" << (response_bytes.load() / 1024) << "KB sent), bad requests: "
+                  << bad_requests.load() << std::endl;
         
         // Print cache statistics
         file_handler.printCacheStats();
@@ -386,6 +542,12 @@ std::string Server::reasonToString(ConnectionEndReason reason) {
     }
 }
 
+void Server::setAdaptiveCacheBounds(size_t floor_mb, size_t ceiling_mb) {
+    adaptive_cache = true;
+    memory_monitor_config.floor_bytes = floor_mb * 1024 * 1024;
+    memory_monitor_config.ceiling_bytes = ceiling_mb * 1024 * 1024;
+}
+
 void Server::stop() {
     if (running) {
         running = false;
@@ -395,6 +557,10 @@ void Server::stop() {
         if (thread_pool) {
             thread_pool->printStatus();
         }
+
+        if (!cache_snapshot_path.empty()) {
+            file_handler.saveCacheSnapshot(cache_snapshot_path);
+        }
     }
     
     if (server_socket != -1) {
@@ -403,6 +569,11 @@ void Server::stop() {
         std::cout << "[Server] Socket closed" << std::endl;
     }
     
+    file_handler.stopWatching();
+    if (memory_monitor) {
+        memory_monitor->stop();
+    }
+
     // Shutdown thread pool
     if (thread_pool) {  
         std::cout << "[Server] Shutting down thread pool..." << std::endl;
@@ -11,34 +11,56 @@
 #include <arpa/inet.h>
 #include <stdexcept>
 #include "HttpRequest.h"
+#include "HttpRequestView.h"
 #include "HttpParser.h"
+#include "HttpRequestParser.h"
+#include "HttpBodyDecoder.h"
+#include "HttpResponse.h"
 #include "FileHandler.h"
+#include "UploadHandler.h"
+#include "StaticResponses.h"
 #include "ResponseGenerator.h"
 #include "ThreadPool.h"
 #include "Connection.h"
 #include <FileCache.h>
+#include "MemoryPressureMonitor.h"
+#include "StripedCounter.h"
 
 class Server {
+    friend class ServerTestAccess;  // Unit tests drive handleConnection over a socketpair
+
 private:
     int server_socket;
     int port;
     struct sockaddr_in server_addr;
     bool running;
     FileHandler file_handler;  // Add file handler
+    UploadHandler upload_handler;  // Streams /upload/ bodies to disk when enabled
+    StaticResponses static_responses;  // /about, /status, 404 and 405, built once
+    std::string warmup_manifest;  // Empty: warm up from a document root scan
+    std::string cache_snapshot_path;  // Empty: no cache persistence
+    bool adaptive_cache = false;  // Resize the cache from cgroup limits and PSI
+    MemoryPressureMonitor::Config memory_monitor_config;
+    std::unique_ptr<MemoryPressureMonitor> memory_monitor;
     std::unique_ptr<ThreadPool> thread_pool;  // Thread pool for handling requests
 
     // High traffic control
     std::atomic<int> active_connections;
     int max_keepalive_connections;
 
+    // Request statistics, striped per worker thread
+    StripedCounter requests_served;
+    StripedCounter bad_requests;
+    StripedCounter response_bytes;
+
     // Helper methods
     void setupSocket();
     void bindSocket();
     void startListening();
     void handleClient(int client_socket);
     void handleConnection(std::unique_ptr<Connection> connection);       
-    std::string routeRequest(const HttpRequest& request);
-    std::string addKeepAliveHeaders(const std::string& response, bool keep_alive, const Connection* connection);
+    HttpResponse routeRequest(const HttpRequestView& request,
+                              std::pmr::memory_resource* arena = std::pmr::get_default_resource());
     std::string reasonToString(ConnectionEndReason reason);
     int getActiveConnections() const { return active_connections.load(); }
     int getMaxKeepAliveConnections() const { return max_keepalive_connections; }
@@ -53,6 +75,19 @@ public:
     void stop();
     int getPort() const { return port; }
     bool isRunning() const { return running; }
+    void setWarmupManifest(const std::string& path) { warmup_manifest = path; }
+    // Load "<glob> <seconds>" TTL rules for stale-while-revalidate caching
+    bool setCacheTtlRules(const std::string& rules_path);
+    void setCacheSnapshotPath(const std::string& path) { cache_snapshot_path = path; }
+    void setAdaptiveCacheBounds(size_t floor_mb, size_t ceiling_mb);
+    // Accept PUT/POST bodies under /upload/ into `directory`
+    bool setUploadDirectory(const std::string& directory, uint64_t max_bytes = UploadHandler::kDefaultMaxBytes) {
+        return upload_handler.configure(directory, max_bytes);
+    }
+
+    // Bodies sent to routes that don't read them are skipped up to this
+    // size; a larger one gets 413 and the connection is closed
+    static constexpr uint64_t kMaxDiscardedBodyBytes = 64 * 1024;
 };
 
 #endif // SERVER_H
\ No newline at end of file
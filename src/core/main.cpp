@@ -1,6 +1,7 @@
 #include <iostream>
 #include <csignal>
 #include "Server.h"
+#include "FileCache.h"
 
 // Global server instance for signal handling
 Server* global_server = nullptr;
@@ -20,25 +21,145 @@ int main(int argc, char* argv[]) {
     std::cout << "Version: 1.0.0 - Basic Socket Implementation" << std::endl;
     std::cout << "=========================================" << std::endl;
     
-    // Parse command line arguments
+    // Parse command line arguments:
+    //   webserver [port [manifest]] [--warmup-manifest FILE] [--cache-snapshot FILE]
+    //             [--huge-pages off|thp|hugetlb] [--cache-floor-mb N] [--cache-ceiling-mb N]
+    //             [--cache-backend locked|rcu] [--cache-ttl-rules FILE]
+    //             [--upload-dir DIR] [--max-upload-mb N]
     int port = 8080;
-    if (argc > 1) {
+    std::string warmup_manifest;
+    std::string cache_snapshot;
+    std::string cache_ttl_rules;
+    std::string upload_dir;
+    long max_upload_mb = UploadHandler::kDefaultMaxBytes / (1024 * 1024);
+    HugePageMode huge_pages = HugePageMode::Off;
+    long cache_floor_mb = -1;    // Either bound enables adaptive cache sizing
+    long cache_ceiling_mb = -1;
+    CacheBackend cache_backend = CacheBackend::Locked;
+    auto isOption = [](const char* arg) { return std::string(arg).rfind("--", 0) == 0; };
+
+    // The port and, as before --warmup-manifest existed, the manifest may
+    // still be given positionally; options follow them
+    int next = 1;
+    if (argc > next && !isOption(argv[next])) {
         try {
-            port = std::stoi(argv[1]);
+            port = std::stoi(argv[next]);
             if (port < 1024 || port > 65535) {
                 std::cerr << "Error: Port must be between 1024 and 65535" << std::endl;
                 return 1;
             }
         } catch (const std::exception& e) {
-            std::cerr << "Error: Invalid port number '" << argv[1] << "'" << std::endl;
+            std::cerr << "Error: Invalid port number '" << argv[next] << "'" << std::endl;
             return 1;
         }
+        next++;
+        if (argc > next && !isOption(argv[next])) {
+            warmup_manifest = argv[next++];
+        }
     }
-    
+
+    for (int i = next; i < argc; i += 2) {
+        std::string option = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Error: " << option << " expects a value" << std::endl;
+            return 1;
+        }
+        if (option == "--warmup-manifest") {
+            warmup_manifest = argv[i + 1];
+        } else if (option == "--cache-snapshot") {
+            cache_snapshot = argv[i + 1];
+        } else if (option == "--cache-ttl-rules") {
+            cache_ttl_rules = argv[i + 1];
+        } else if (option == "--upload-dir") {
+            upload_dir = argv[i + 1];
+        } else if (option == "--max-upload-mb") {
+            try {
+                max_upload_mb = std::stol(argv[i + 1]);
+            } catch (const std::exception&) {
+                max_upload_mb = -1;
+            }
+            if (max_upload_mb <= 0) {
+                std::cerr << "Error: --max-upload-mb expects a size in MB" << std::endl;
+                return 1;
+            }
+        } else if (option == "--cache-floor-mb" || option == "--cache-ceiling-mb") {
+            long value;
+            try {
+                value = std::stol(argv[i + 1]);
+            } catch (const std::exception&) {
+                value = -1;
+            }
+            if (value < 0) {
+                std::cerr << "Error: " << option << " expects a size in MB" << std::endl;
+                return 1;
+            }
+            if (option == "--cache-floor-mb") {
+                cache_floor_mb = value;
+            } else {
+                cache_ceiling_mb = value;
+            }
+        } else if (option == "--cache-backend") {
+            std::string backend = argv[i + 1];
+            if (backend == "locked") {
+                cache_backend = CacheBackend::Locked;
+            } else if (backend == "rcu") {
+                cache_backend = CacheBackend::RCU;
+            } else {
+                std::cerr << "Error: --cache-backend expects locked or rcu" << std::endl;
+                return 1;
+            }
+        } else if (option == "--huge-pages") {
+            std::string mode = argv[i + 1];
+            if (mode == "off") {
+                huge_pages = HugePageMode::Off;
+            } else if (mode == "thp") {
+                huge_pages = HugePageMode::Transparent;
+            } else if (mode == "hugetlb") {
+                huge_pages = HugePageMode::HugeTLB;
+            } else {
+                std::cerr << "Error: --huge-pages expects off, thp or hugetlb" << std::endl;
+                return 1;
+            }
+        } else {
+            std::cerr << "Error: Unknown option '" << option << "'" << std::endl;
+            return 1;
+        }
+    }
+
+    // Must be set before the first file is cached
+    SlabAllocator::instance().setHugePageMode(huge_pages);
+
+    // The first call creates the shared cache, so pick its backend up front
+    FileCacheManager::get_instance(100, 20, CachePolicyType::WTinyLFU, cache_backend);
+
     try {
         // Create server instance
         Server server(port);
         global_server = &server;
+
+        // Optional cache warm-up manifest ("/path [pin]" per line) and
+        // snapshot file restored at startup / written at shutdown
+        server.setWarmupManifest(warmup_manifest);
+        server.setCacheSnapshotPath(cache_snapshot);
+
+        // Optional per-path TTLs ("<glob> <seconds>" per line): expired
+        // entries are served while they are revalidated in the background
+        if (!cache_ttl_rules.empty() && !server.setCacheTtlRules(cache_ttl_rules)) {
+            return 1;
+        }
+
+        // Optional uploads: PUT/POST /upload/<name> streams the body to DIR/<name>
+        if (!upload_dir.empty() &&
+            !server.setUploadDirectory(upload_dir, static_cast<uint64_t>(max_upload_mb) * 1024 * 1024)) {
+            return 1;
+        }
+
+        // Adapt the cache budget to cgroup limits and memory pressure.
+        // Default ceiling (0) is the configured cache capacity.
+        if (cache_floor_mb >= 0 || cache_ceiling_mb >= 0) {
+            server.setAdaptiveCacheBounds(cache_floor_mb >= 0 ? cache_floor_mb : 8,
+                                          cache_ceiling_mb >= 0 ? cache_ceiling_mb : 0);
+        }
         
         // Setup signal handlers for graceful shutdown
         signal(SIGINT, signalHandler);   // Ctrl+C
@@ -0,0 +1,128 @@
+#include "DocumentIndex.h"
+#include <iostream>
+#include <sstream>
+#include <filesystem>
+#include <mutex>
+#include <sys/stat.h>
+
+DocumentIndex::DocumentIndex(const std::string& root, MimeResolver resolver)
+    : document_root(root), mime_resolver(std::move(resolver)) {
+}
+
+std::shared_ptr<const DocumentInfo> DocumentIndex::statFile(const std::string& path) const {
+    struct stat st;
+    std::string full_path = document_root + path;
+    if (stat(full_path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+        return nullptr;
+    }
+
+    auto info = std::make_shared<DocumentInfo>();
+    info->path = path;
+    info->size_bytes = static_cast<size_t>(st.st_size);
+    info->mtime = st.st_mtim.tv_sec;
+    info->mime_type = mime_resolver(full_path);
+
+    // "<mtime sec hex>.<mtime nsec hex>-<size hex>": nginx's "<mtime>-<size>"
+    // plus nanoseconds, so quick successive deploys still change the validator
+    std::ostringstream etag;
+    etag << '"' << std::hex << st.st_mtim.tv_sec << '.' << st.st_mtim.tv_nsec << '-' << st.st_size << '"';
+    info->etag = etag.str();
+    return info;
+}
+
+void DocumentIndex::scanDirectory(const std::string& relative_dir) {
+    std::error_code ec;
+    std::filesystem::path base(document_root + relative_dir);
+    for (auto it = std::filesystem::recursive_directory_iterator(base, ec);
+         it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+        if (ec) {
+            break;
+        }
+        if (!it->is_regular_file(ec)) {
+            continue;
+        }
+        std::string path = relative_dir + "/" +
+            std::filesystem::relative(it->path(), base, ec).generic_string();
+        if (auto info = statFile(path)) {
+            entries[path] = info;
+        }
+    }
+}
+
+size_t DocumentIndex::build() {
+    std::unique_lock<std::shared_mutex> lock(index_mutex);
+    entries.clear();
+    scanDirectory("");
+
+    std::cout << "[DocumentIndex] Indexed " << entries.size() << " files under "
+              << document_root << std::endl;
+    return entries.size();
+}
+
+void DocumentIndex::setDocumentRoot(const std::string& root) {
+    {
+        std::unique_lock<std::shared_mutex> lock(index_mutex);
+        document_root = root;
+    }
+    build();
+}
+
+bool DocumentIndex::contains(const std::string& path) const {
+    std::shared_lock<std::shared_mutex> lock(index_mutex);
+    return entries.find(path) != entries.end();
+}
+
+std::shared_ptr<const DocumentInfo> DocumentIndex::lookup(const std::string& path) const {
+    std::shared_lock<std::shared_mutex> lock(index_mutex);
+    auto it = entries.find(path);
+    return it != entries.end() ? it->second : nullptr;
+}
+
+size_t DocumentIndex::size() const {
+    std::shared_lock<std::shared_mutex> lock(index_mutex);
+    return entries.size();
+}
+
+std::vector<std::shared_ptr<const DocumentInfo>> DocumentIndex::list() const {
+    std::shared_lock<std::shared_mutex> lock(index_mutex);
+    std::vector<std::shared_ptr<const DocumentInfo>> result;
+    result.reserve(entries.size());
+    for (const auto& entry : entries) {
+        result.push_back(entry.second);
+    }
+    return result;
+}
+
+std::shared_ptr<const DocumentInfo> DocumentIndex::refresh(const std::string& path) {
+    auto info = statFile(path);
+
+    std::unique_lock<std::shared_mutex> lock(index_mutex);
+    if (info) {
+        entries[path] = info;
+    } else {
+        entries.erase(path);
+    }
+    return info;
+}
+
+void DocumentIndex::remove(const std::string& path) {
+    std::unique_lock<std::shared_mutex> lock(index_mutex);
+    entries.erase(path);
+}
+
+void DocumentIndex::rescan(const std::string& relative_dir) {
+    std::string prefix = relative_dir == "/" ? "/" : relative_dir + "/";
+
+    std::unique_lock<std::shared_mutex> lock(index_mutex);
+    for (auto it = entries.begin(); it != entries.end(); ) {
+        if (it->first.compare(0, prefix.size(), prefix) == 0) {
+            it = entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    scanDirectory(relative_dir == "/" ? "" : relative_dir);
+
+    std::cout << "[DocumentIndex] Rescanned " << relative_dir << " (" << entries.size()
+              << " files indexed)" << std::endl;
+}
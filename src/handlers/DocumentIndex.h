@@ -0,0 +1,57 @@
+#ifndef DOCUMENT_INDEX_H
+#define DOCUMENT_INDEX_H
+
+#include <string>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include <shared_mutex>
+#include <ctime>
+
+// Metadata for one servable file under the document root
+struct DocumentInfo {
+    std::string path;        // Request path, e.g. "/css/style.css"
+    size_t size_bytes;
+    std::time_t mtime;
+    std::string mime_type;
+    std::string etag;        // Validator derived from size and mtime
+};
+
+// In-memory index of every regular file under the document root. Built once
+// at startup and updated incrementally from file watcher events, so existence
+// checks, 404s and MIME lookups on the request path are hash lookups with no
+// filesystem access.
+class DocumentIndex {
+public:
+    using MimeResolver = std::function<std::string(const std::string& path)>;
+
+private:
+    std::string document_root;
+    MimeResolver mime_resolver;
+    std::unordered_map<std::string, std::shared_ptr<const DocumentInfo>> entries;
+    mutable std::shared_mutex index_mutex;
+
+    std::shared_ptr<const DocumentInfo> statFile(const std::string& path) const;
+    void scanDirectory(const std::string& relative_dir);
+
+public:
+    DocumentIndex(const std::string& root, MimeResolver resolver);
+
+    // Full scan of the document root (replaces the current contents)
+    size_t build();
+    void setDocumentRoot(const std::string& root);
+
+    // Request path lookups
+    bool contains(const std::string& path) const;
+    std::shared_ptr<const DocumentInfo> lookup(const std::string& path) const;
+    size_t size() const;
+    std::vector<std::shared_ptr<const DocumentInfo>> list() const;
+
+    // Incremental maintenance
+    std::shared_ptr<const DocumentInfo> refresh(const std::string& path);
+    void remove(const std::string& path);
+    void rescan(const std::string& relative_dir);
+};
+
+#endif // DOCUMENT_INDEX_H
@@ -3,36 +3,102 @@
 
 #include <string>
 #include <map>
+#include <vector>
 #include <fstream>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <unordered_set>
 #include "HttpRequest.h"
+#include "HttpResponse.h"
 #include "FileCache.h"
+#include "FileWatcher.h"
+#include "ThreadPool.h"
+#include "DocumentIndex.h"
+#include "TtlRules.h"
+
+// Result of a cache warm-up run
+struct WarmupReport {
+    size_t files_loaded = 0;
+    size_t files_failed = 0;
+    size_t files_pinned = 0;
+    size_t bytes_loaded = 0;
+    double elapsed_ms = 0;
+};
+
 class FileHandler {
 private:
     std::string document_root;
     std::map<std::string, std::string> mime_types;
+    DocumentIndex document_index;          // Servable files, kept current by the watcher
+    std::unique_ptr<FileWatcher> watcher;  // inotify based cache invalidation
+    bool installed_cache_validator;        // This handler validates restored cache entries
+
+    // Stale-while-revalidate for paths with a TTL: expired entries are served
+    // while one background check per path runs on revalidation_pool
+    TtlRules ttl_rules;
+    std::mutex revalidation_mutex;
+    std::unordered_set<std::string> revalidating;
+    std::unique_ptr<ThreadPool> revalidation_pool;
     
     // Helper methods
     void initializeMimeTypes();
     std::string getMimeType(const std::string& file_path);
     std::string getFileExtension(const std::string& file_path);
-    bool fileExists(const std::string& file_path);
+    std::shared_ptr<const DocumentInfo> findDocument(const std::string& path);
     bool isValidPath(const std::string& path);
-    std::string readFileContent(const std::string& file_path, bool& success);
+    SegmentedBuffer readFileContent(const std::string& file_path, bool& success);
     std::size_t getFileSize(const std::string& file_path);
     std::string createErrorResponse(int status_code, const std::string& status_text, const std::string& message);
+    void onFileChanged(const std::string& path, FileEvent event);
+    void scheduleRevalidation(const std::string& path, std::shared_ptr<const CachedFile> stale);
+    void revalidate(const std::string& path, const CachedFile& stale);
+
+    // Warm-up helpers: (request path, pin) pairs to preload
+    std::vector<std::pair<std::string, bool>> loadWarmupManifest(const std::string& manifest_path);
+    std::vector<std::pair<std::string, bool>> scanDocumentRoot(size_t budget_bytes);
 public:
     FileHandler(const std::string& root = "./public");
+    ~FileHandler();
     
-    // Main file serving method
-    std::string serveFile(const std::string& request_path);
+    // Main file serving method. A cache hit builds its response head in
+    // `arena` and allocates nothing else. With head_only (a HEAD request)
+    // the response has the same headers and no body.
+    HttpResponse serveFile(const std::string& request_path,
+                           std::pmr::memory_resource* arena = std::pmr::get_default_resource(),
+                           bool head_only = false);
     
     // Check if file can be served
     bool canServeFile(const std::string& request_path);
-    std::string buildHttpResponse(const CachedFile& cached_file);
+    // Headers as text; the body references the cached segments
+    HttpResponse buildHttpResponse(std::shared_ptr<const CachedFile> cached_file,
+                                   std::pmr::memory_resource* arena = std::pmr::get_default_resource(),
+                                   bool head_only = false);
     // Utility methods
     std::string getDocumentRoot() const { return document_root; }
-    void setDocumentRoot(const std::string& root) { document_root = root; }
+    void setDocumentRoot(const std::string& root);
+    const DocumentIndex& getDocumentIndex() const { return document_index; }
     void printCacheStats() const;
+
+    // Document root watching (keeps the cache coherent with the disk)
+    bool startWatching();
+    void stopWatching();
+    bool isWatching() const { return watcher && watcher->isRunning(); }
+
+    // TTLs for files the watcher cannot see change (e.g. NFS). Set before
+    // serving; an expired entry is served while it is revalidated.
+    void setTtlRules(TtlRules rules);
+
+    // Preload the cache in parallel before serving traffic. With a manifest
+    // (one "/path [pin]" per line) only the listed files are loaded and the
+    // ones marked "pin" are never evicted; otherwise the whole document root
+    // is loaded, smallest files first, up to the cache capacity.
+    WarmupReport warmCache(ThreadPool& pool, const std::string& manifest_path = "");
+
+    // Cache persistence across restarts. Restored entries are checked against
+    // the document index (ETag) on their first hit, not at load time.
+    bool saveCacheSnapshot(const std::string& snapshot_path) const;
+    bool restoreCacheSnapshot(const std::string& snapshot_path);
 };
 
 #endif
\ No newline at end of file
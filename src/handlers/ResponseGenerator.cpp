@@ -1,17 +1,16 @@
 #include "ResponseGenerator.h"
+#include "ResponseBuilder.h"
 
 std::string ResponseGenerator::createHttpResponse(const std::string& body, 
                                                 const std::string& content_type,
                                                 int status_code,
                                                 const std::string& status_text) {
     std::string response;
-    response += "HTTP/1.1 " + std::to_string(status_code) + " " + status_text + "\r\n";
-    response += "Content-Type: " + content_type + "\r\n";
-    response += "Content-Length: " + std::to_string(body.length()) + "\r\n";
-    response += "Server: CustomHTTPServer/1.0\r\n";
-    response += "Connection: close\r\n";
-    response += "\r\n";
-    response += body;
+    ResponseBuilder(response, body.size())
+        .status(status_code, status_text)
+        .header("Content-Type", content_type)
+        .standardHeaders()
+        .body(body);
     return response;
 }
 
@@ -131,7 +130,15 @@ std::string ResponseGenerator::createHomePageResponse(int port) {
 }
 
 std::string ResponseGenerator::createAboutPageResponse() {
-    static std::string html_body = R"(<!DOCTYPE html>
+    return createHttpResponse(aboutPageHtml());
+}
+
+std::string ResponseGenerator::createStatusPageResponse() {
+    return createHttpResponse(statusPageHtml());
+}
+
+const std::string& ResponseGenerator::aboutPageHtml() {
+    static const std::string html_body = R"(<!DOCTYPE html>
 <html lang="en">
 <head>
     <meta charset="UTF-8">
@@ -534,12 +541,11 @@ std::string ResponseGenerator::createAboutPageResponse() {
     </div>
 </body>
 </html>)";
-    
-    return createHttpResponse(html_body);
+    return html_body;
 }
 
-std::string ResponseGenerator::createStatusPageResponse(int port) {
-    static std::string html_body = R"(<!DOCTYPE html>
+const std::string& ResponseGenerator::statusPageHtml() {
+    static const std::string html_body = R"(<!DOCTYPE html>
 <html lang="en">
 <head>
     <meta charset="UTF-8">
@@ -1195,8 +1201,7 @@ Keep-Alive: Disabled (>10 connections)</div>
     </div>
 </body>
 </html>)";
-    
-    return createHttpResponse(html_body);
+    return html_body;
 }
 
 std::string ResponseGenerator::createErrorResponse(int status_code, const std::string& message) {
@@ -1206,23 +1211,75 @@ std::string ResponseGenerator::createErrorResponse(int status_code, const std::s
 }
 
 std::string ResponseGenerator::create404Response() {
-    return createErrorResponse(404, "The requested page could not be found.");
+    return createErrorResponse(404, getErrorMessage(404));
 }
 
 std::string ResponseGenerator::create400Response() {
-    return createErrorResponse(400, "The request could not be understood by the server.");
+    return createErrorResponse(400, getErrorMessage(400));
+}
+
+std::string ResponseGenerator::create414Response() {
+    return createErrorResponse(414, getErrorMessage(414));
+}
+
+std::string ResponseGenerator::create411Response() {
+    return createErrorResponse(411, getErrorMessage(411));
+}
+
+std::string ResponseGenerator::create413Response() {
+    return createErrorResponse(413, getErrorMessage(413));
+}
+
+std::string ResponseGenerator::create417Response() {
+    return createErrorResponse(417, getErrorMessage(417));
+}
+
+std::string ResponseGenerator::create431Response() {
+    return createErrorResponse(431, getErrorMessage(431));
 }
 
 std::string ResponseGenerator::create500Response() {
-    return createErrorResponse(500, "An internal server error occurred.");
+    return createErrorResponse(500, getErrorMessage(500));
+}
+
+std::string ResponseGenerator::create501Response() {
+    return createErrorResponse(501, getErrorMessage(501));
+}
+
+std::string ResponseGenerator::errorPageHtml(int status_code) {
+    return createErrorHtml(status_code, getStatusText(status_code), getErrorMessage(status_code));
+}
+
+std::string ResponseGenerator::getErrorMessage(int status_code) {
+    switch (status_code) {
+        case 400: return "The request could not be understood by the server.";
+        case 404: return "The requested page could not be found.";
+        case 405: return "The requested resource does not support this method.";
+        case 411: return "The request needs a Content-Length or a chunked body.";
+        case 413: return "The request body is larger than the server accepts.";
+        case 414: return "The request line is longer than the server accepts.";
+        case 417: return "The server cannot meet the request's Expect header.";
+        case 431: return "The request headers are larger than the server accepts.";
+        case 500: return "An internal server error occurred.";
+        case 501: return "The request uses a transfer coding the server does not support.";
+        default: return "The request could not be completed.";
+    }
 }
 
 std::string ResponseGenerator::getStatusText(int status_code) {
     switch (status_code) {
         case 200: return "OK";
+        case 201: return "Created";
         case 400: return "Bad Request";
         case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 411: return "Length Required";
+        case 413: return "Content Too Large";
+        case 414: return "URI Too Long";
+        case 417: return "Expectation Failed";
+        case 431: return "Request Header Fields Too Large";
         case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
         default: return "Unknown Status";
     }
 }
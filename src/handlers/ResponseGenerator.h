@@ -8,13 +8,24 @@ public:
     // Static HTML page generators
     static std::string createHomePageResponse(int port);
     static std::string createAboutPageResponse();
-    static std::string createStatusPageResponse(int port);
+    static std::string createStatusPageResponse();
+
+    // Page bodies on their own, for the responses StaticResponses builds once
+    static const std::string& aboutPageHtml();
+    static const std::string& statusPageHtml();
+    static std::string errorPageHtml(int status_code);
     
     // Error response generators
     static std::string createErrorResponse(int status_code, const std::string& message);
     static std::string create404Response();
     static std::string create400Response(); 
+    static std::string create414Response();
+    static std::string create411Response();
+    static std::string create413Response();
+    static std::string create417Response();
+    static std::string create431Response();
     static std::string create500Response();
+    static std::string create501Response();
     
     // Basic HTTP response wrapper
     static std::string createHttpResponse(const std::string& body, 
@@ -22,9 +33,11 @@ public:
                                         int status_code = 200,
                                         const std::string& status_text = "OK");
 
+    static std::string getStatusText(int status_code);
+
 private:
     // Helper methods
-    static std::string getStatusText(int status_code);
+    static std::string getErrorMessage(int status_code);
     static std::string createErrorHtml(int status_code, const std::string& title, const std::string& message);
 };
 
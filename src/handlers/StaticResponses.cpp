@@ -0,0 +1,135 @@
+#include "StaticResponses.h"
+#include "ResponseGenerator.h"
+#include "ResponseBuilder.h"
+#include "HttpHeaders.h"
+#include <iostream>
+#include <zlib.h>
+
+namespace {
+
+std::string_view trim(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+// "q=0", "q=0.", "q=0.000" among a coding's parameters
+bool hasZeroQuality(std::string_view parameters) {
+    while (!parameters.empty()) {
+        size_t semicolon = parameters.find(';');
+        std::string_view parameter = trim(parameters.substr(0, semicolon));
+        parameters = semicolon == std::string_view::npos ? std::string_view() : parameters.substr(semicolon + 1);
+        if (parameter.size() < 3 || (parameter[0] != 'q' && parameter[0] != 'Q') || parameter[1] != '=') {
+            continue;
+        }
+        std::string_view weight = parameter.substr(2);
+        return weight[0] == '0' && weight.find_first_not_of(".0") == std::string_view::npos;
+    }
+    return false;
+}
+
+} // namespace
+
+StaticResponses::StaticResponses() {
+    pages[static_cast<size_t>(Page::About)] = build(200, ResponseGenerator::aboutPageHtml());
+    pages[static_cast<size_t>(Page::Status)] = build(200, ResponseGenerator::statusPageHtml());
+    pages[static_cast<size_t>(Page::NotFound)] = build(404, ResponseGenerator::errorPageHtml(404));
+    pages[static_cast<size_t>(Page::MethodNotAllowed)] =
+        build(405, ResponseGenerator::errorPageHtml(405), "GET, HEAD");
+
+    size_t identity_bytes = 0;
+    size_t gzip_bytes = 0;
+    for (const Prebuilt& page : pages) {
+        identity_bytes += page.identity->size();
+        gzip_bytes += page.gzipped ? page.gzipped->size() : page.identity->size();
+    }
+    std::cout << "[StaticResponses] Prebuilt " << pages.size() << " pages (" << identity_bytes
+              << " bytes, " << gzip_bytes << " gzipped)" << std::endl;
+}
+
+StaticResponses::Prebuilt StaticResponses::build(int status_code, const std::string& html, std::string_view allow) {
+    Prebuilt page;
+    page.status_code = status_code;
+    page.status_text = ResponseGenerator::getStatusText(status_code);
+    page.allow = allow;
+    page.identity = std::make_shared<const SegmentedBuffer>(html);
+    std::string compressed = gzip(html);
+    if (!compressed.empty() && compressed.size() < html.size()) {
+        page.gzipped = std::make_shared<const SegmentedBuffer>(compressed);
+    }
+    return page;
+}
+
+HttpResponse StaticResponses::serve(Page page, const HttpRequestView& request,
+                                    std::pmr::memory_resource* arena) const {
+    const Prebuilt& prebuilt = pages[static_cast<size_t>(page)];
+    bool use_gzip = prebuilt.gzipped && acceptsGzip(request.getHeader(HttpHeader::AcceptEncoding));
+    const std::shared_ptr<const SegmentedBuffer>& body = use_gzip ? prebuilt.gzipped : prebuilt.identity;
+
+    std::pmr::string head(arena);
+    PmrResponseBuilder builder(head);
+    builder.status(prebuilt.status_code, prebuilt.status_text)
+        .header("Content-Type", "text/html")
+        .header("Content-Length", static_cast<uint64_t>(body->size()));
+    if (use_gzip) {
+        builder.header("Content-Encoding", "gzip");
+    }
+    if (prebuilt.gzipped) {
+        builder.header("Vary", "Accept-Encoding");
+    }
+    if (!prebuilt.allow.empty()) {
+        builder.header("Allow", prebuilt.allow);
+    }
+    builder.standardHeaders().endHeaders();
+
+    // HEAD gets the same headers, Content-Length included, and no body
+    if (request.method_id == HttpMethod::Head) {
+        return HttpResponse(std::move(head), nullptr);
+    }
+    return HttpResponse(std::move(head), body);
+}
+
+bool StaticResponses::acceptsGzip(std::string_view accept_encoding) {
+    int gzip = -1;  // -1: not listed, 0: refused, 1: accepted
+    int any = -1;
+    while (!accept_encoding.empty()) {
+        size_t comma = accept_encoding.find(',');
+        std::string_view item = accept_encoding.substr(0, comma);
+        accept_encoding = comma == std::string_view::npos ? std::string_view() : accept_encoding.substr(comma + 1);
+
+        size_t semicolon = item.find(';');
+        std::string_view coding = trim(item.substr(0, semicolon));
+        int accepted = semicolon != std::string_view::npos && hasZeroQuality(item.substr(semicolon + 1)) ? 0 : 1;
+        if (HttpHeaderNames::equalsIgnoreCase(coding, "gzip") || HttpHeaderNames::equalsIgnoreCase(coding, "x-gzip")) {
+            gzip = accepted;
+        } else if (coding == "*") {
+            any = accepted;
+        }
+    }
+    return gzip != -1 ? gzip == 1 : any == 1;
+}
+
+std::string StaticResponses::gzip(std::string_view data) {
+    z_stream stream{};
+    // 15 window bits + 16: a gzip header and trailer instead of zlib's
+    if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 9, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return {};
+    }
+    std::string compressed(deflateBound(&stream, data.size()), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(compressed.data());
+    stream.avail_out = static_cast<uInt>(compressed.size());
+    int result = deflate(&stream, Z_FINISH);
+    compressed.resize(stream.total_out);
+    deflateEnd(&stream);
+    if (result != Z_STREAM_END) {
+        std::cerr << "[StaticResponses] gzip failed: " << result << std::endl;
+        return {};
+    }
+    return compressed;
+}
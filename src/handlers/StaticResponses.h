@@ -0,0 +1,57 @@
+#ifndef STATIC_RESPONSES_H
+#define STATIC_RESPONSES_H
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <memory_resource>
+#include <cstdint>
+#include "HttpRequestView.h"
+#include "HttpResponse.h"
+#include "SegmentedBuffer.h"
+
+// The generated pages whose content never changes at runtime: /about,
+// /status and the 404 and 405 pages. Each body is built once, when the
+// server is constructed, together with its gzip encoding, into an immutable
+// SegmentedBuffer. Serving a page writes only the short head (status,
+// Content-Length, Date) into the request arena and shares the body, so the
+// HTML is never rebuilt or copied and writeTo() sends it with one writev.
+class StaticResponses {
+public:
+    enum class Page : uint8_t {
+        About,
+        Status,
+        NotFound,
+        MethodNotAllowed,  // Allows GET and HEAD, like Server::routeRequest
+        Count
+    };
+
+    StaticResponses();
+
+    // The page, gzip-encoded if the request accepts it, without a body for HEAD
+    HttpResponse serve(Page page, const HttpRequestView& request,
+                       std::pmr::memory_resource* arena = std::pmr::get_default_resource()) const;
+
+    // Whether an Accept-Encoding value allows gzip: listed (or covered by
+    // "*") and not with q=0 (RFC 9110 12.5.3)
+    static bool acceptsGzip(std::string_view accept_encoding);
+
+    // gzip at the best compression level; empty if zlib fails
+    static std::string gzip(std::string_view data);
+
+private:
+    struct Prebuilt {
+        int status_code = 200;
+        std::string status_text;
+        std::string_view allow;                          // Allow header value, 405 only
+        std::shared_ptr<const SegmentedBuffer> identity;
+        std::shared_ptr<const SegmentedBuffer> gzipped;  // nullptr unless smaller than identity
+    };
+
+    std::array<Prebuilt, static_cast<size_t>(Page::Count)> pages;
+
+    static Prebuilt build(int status_code, const std::string& html, std::string_view allow = {});
+};
+
+#endif // STATIC_RESPONSES_H
@@ -0,0 +1,146 @@
+#include "UploadHandler.h"
+#include "ResponseGenerator.h"
+#include <iostream>
+#include <filesystem>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+namespace {
+
+// One upload in progress: appends to a temporary file in the upload
+// directory, renamed over the destination when the body is complete and
+// removed otherwise
+class UploadBody : public HttpBodyHandler {
+public:
+    UploadBody(int fd, std::string temp_path, std::string final_path, uint64_t max_bytes)
+        : fd(fd), temp_path(std::move(temp_path)), final_path(std::move(final_path)), max_bytes(max_bytes) {}
+
+    ~UploadBody() override {
+        if (fd != -1) {
+            close(fd);
+        }
+        if (!stored) {
+            unlink(temp_path.c_str());
+        }
+    }
+
+    bool onBodyData(std::string_view data) override {
+        if (received + data.size() > max_bytes) {
+            too_large = true;
+            return false;
+        }
+        received += data.size();
+        while (!data.empty()) {
+            ssize_t written = write(fd, data.data(), data.size());
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                std::cerr << "[UploadHandler] Write failed for " << final_path << ": "
+                          << std::strerror(errno) << std::endl;
+                return false;
+            }
+            data.remove_prefix(static_cast<size_t>(written));
+        }
+        return true;
+    }
+
+    HttpResponse onBodyComplete() override {
+        int result = close(fd);
+        fd = -1;
+        if (result != 0 || std::rename(temp_path.c_str(), final_path.c_str()) != 0) {
+            std::cerr << "[UploadHandler] Failed to store " << final_path << ": "
+                      << std::strerror(errno) << std::endl;
+            return ResponseGenerator::create500Response();
+        }
+        stored = true;
+        std::cout << "[UploadHandler] Stored " << final_path << " (" << received << " bytes)" << std::endl;
+        return ResponseGenerator::createHttpResponse(
+            "Stored " + std::to_string(received) + " bytes\n", "text/plain", 201, "Created");
+    }
+
+    HttpResponse onBodyError() override {
+        if (too_large) {
+            return ResponseGenerator::create413Response();
+        }
+        return ResponseGenerator::create500Response();
+    }
+
+private:
+    int fd;
+    std::string temp_path;
+    std::string final_path;
+    uint64_t max_bytes;
+    uint64_t received = 0;
+    bool too_large = false;
+    bool stored = false;
+};
+
+} // namespace
+
+bool UploadHandler::configure(const std::string& directory, uint64_t max_bytes) {
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error || !std::filesystem::is_directory(directory)) {
+        std::cerr << "[UploadHandler] Upload directory unavailable: " << directory << std::endl;
+        return false;
+    }
+    upload_directory = directory;
+    this->max_bytes = max_bytes;
+    std::cout << "[UploadHandler] Accepting uploads into " << upload_directory
+              << " (max " << max_bytes << " bytes)" << std::endl;
+    return true;
+}
+
+bool UploadHandler::handles(const HttpRequestView& request) const {
+    return isEnabled() && (request.method_id == HttpMethod::Put || request.method_id == HttpMethod::Post) &&
+           request.path.substr(0, kPathPrefix.size()) == kPathPrefix;
+}
+
+std::unique_ptr<HttpBodyHandler> UploadHandler::begin(const HttpRequestView& request, const HttpBodyDecoder& body,
+                                                      HttpResponse& rejection) const {
+    std::string_view name = request.path.substr(kPathPrefix.size());
+    if (!isValidName(name)) {
+        rejection = ResponseGenerator::create400Response();
+        return nullptr;
+    }
+    if (!body.hasBody()) {
+        rejection = ResponseGenerator::create411Response();
+        return nullptr;
+    }
+    if (body.framing() == HttpBodyDecoder::Framing::ContentLength && body.contentLength() > max_bytes) {
+        rejection = ResponseGenerator::create413Response();
+        return nullptr;
+    }
+
+    std::string temp_path = upload_directory + "/.upload-XXXXXX";
+    int fd = mkstemp(temp_path.data());
+    if (fd == -1) {
+        std::cerr << "[UploadHandler] Cannot create temporary file in " << upload_directory << ": "
+                  << std::strerror(errno) << std::endl;
+        rejection = ResponseGenerator::create500Response();
+        return nullptr;
+    }
+    std::string final_path = upload_directory + "/" + std::string(name);
+    std::cout << "[UploadHandler] Receiving " << final_path << std::endl;
+    return std::make_unique<UploadBody>(fd, std::move(temp_path), std::move(final_path), max_bytes);
+}
+
+// One path segment of letters, digits, '-', '_' and '.', not starting with
+// '.': no traversal, no hidden files, nothing that collides with temporaries
+bool UploadHandler::isValidName(std::string_view name) {
+    if (name.empty() || name.size() > 255 || name.front() == '.') {
+        return false;
+    }
+    for (char c : name) {
+        bool allowed = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                       c == '-' || c == '_' || c == '.';
+        if (!allowed) {
+            return false;
+        }
+    }
+    return true;
+}
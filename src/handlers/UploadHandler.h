@@ -0,0 +1,43 @@
+#ifndef UPLOAD_HANDLER_H
+#define UPLOAD_HANDLER_H
+
+#include <string>
+#include <string_view>
+#include <memory>
+#include <cstdint>
+#include "HttpRequestView.h"
+#include "HttpResponse.h"
+#include "HttpBodyDecoder.h"
+#include "HttpBodyHandler.h"
+
+// Stores PUT/POST bodies sent to /upload/<name> as <directory>/<name>.
+// Bodies are streamed to a temporary file as they arrive and renamed into
+// place once complete, so an upload is never held in memory and a cut-off
+// upload never replaces an existing file.
+class UploadHandler {
+public:
+    static constexpr std::string_view kPathPrefix = "/upload/";
+    static constexpr uint64_t kDefaultMaxBytes = 100ull * 1024 * 1024;
+
+    // Accept uploads into `directory`, created if missing; disabled until then
+    bool configure(const std::string& directory, uint64_t max_bytes = kDefaultMaxBytes);
+    bool isEnabled() const { return !upload_directory.empty(); }
+    uint64_t getMaxBytes() const { return max_bytes; }
+
+    // A PUT or POST under kPathPrefix, with uploads enabled
+    bool handles(const HttpRequestView& request) const;
+
+    // Starts receiving the request's body. Returns nullptr, with the response
+    // in `rejection`, if the upload is refused before any of it is read: bad
+    // name (400), no framing (411), declared length over the limit (413).
+    std::unique_ptr<HttpBodyHandler> begin(const HttpRequestView& request, const HttpBodyDecoder& body,
+                                           HttpResponse& rejection) const;
+
+private:
+    std::string upload_directory;
+    uint64_t max_bytes = kDefaultMaxBytes;
+
+    static bool isValidName(std::string_view name);
+};
+
+#endif // UPLOAD_HANDLER_H
@@ -0,0 +1,189 @@
+#include "HttpBodyDecoder.h"
+#include <algorithm>
+
+bool HttpBodyDecoder::start(const HttpRequestView& request) {
+    body_framing = Framing::None;
+    state = State::Done;
+    content_length = remaining = body_bytes = 0;
+    line_bytes = trailer_bytes = 0;
+    saw_digit = saw_cr = false;
+    error_status = 0;
+
+    // Every Content-Length must agree, or the body can't be told from the
+    // next request (request smuggling)
+    bool has_length = false;
+    size_t transfer_encodings = 0;
+    for (size_t i = 0; i < request.header_count; i++) {
+        HttpHeader header = HttpHeaderNames::lookup(request.headers[i].name);
+        if (header == HttpHeader::TransferEncoding) {
+            transfer_encodings++;
+        } else if (header == HttpHeader::ContentLength) {
+            uint64_t length;
+            if (!parseContentLength(request.headers[i].value, length) ||
+                (has_length && length != content_length)) {
+                fail(400);
+                return false;
+            }
+            has_length = true;
+            content_length = length;
+        }
+    }
+
+    if (transfer_encodings > 0) {
+        std::string_view coding = request.getHeader(HttpHeader::TransferEncoding);
+        if (has_length || !request.isHttp11()) {
+            fail(400);
+            return false;
+        }
+        if (transfer_encodings > 1 || !HttpHeaderNames::equalsIgnoreCase(coding, "chunked")) {
+            // Only a final chunked coding frames the body; other codings
+            // could be framed but not decoded
+            size_t last = coding.rfind(',');
+            std::string_view final_coding = coding.substr(last == std::string_view::npos ? 0 : last + 1);
+            while (!final_coding.empty() && (final_coding.front() == ' ' || final_coding.front() == '\t')) {
+                final_coding.remove_prefix(1);
+            }
+            fail(HttpHeaderNames::equalsIgnoreCase(final_coding, "chunked") || transfer_encodings > 1 ? 501 : 400);
+            return false;
+        }
+        body_framing = Framing::Chunked;
+        state = State::ChunkSize;
+        return true;
+    }
+
+    if (has_length) {
+        body_framing = Framing::ContentLength;
+        remaining = content_length;
+        state = remaining > 0 ? State::Data : State::Done;
+    }
+    return true;
+}
+
+HttpBodyDecoder::Status HttpBodyDecoder::decode(std::string_view input, size_t& consumed, HttpBodyHandler* handler) {
+    size_t position = 0;
+    while (position < input.size() && state != State::Done && state != State::Error) {
+        if (state == State::Data) {
+            // The bulk of the body: handed over in place, as large as it came
+            size_t length = static_cast<size_t>(std::min<uint64_t>(remaining, input.size() - position));
+            if (handler && !handler->onBodyData(input.substr(position, length))) {
+                consumed = position;
+                return fail(0);
+            }
+            position += length;
+            body_bytes += length;
+            remaining -= length;
+            if (remaining == 0) {
+                state = body_framing == Framing::Chunked ? State::ChunkDataEnd : State::Done;
+            }
+            continue;
+        }
+
+        // Chunk framing, a byte at a time: "<hex size>[;ext]\r\n<data>\r\n"
+        // repeated, then "0\r\n", trailer lines and an empty line
+        char c = input[position++];
+        if (saw_cr && c != '\n') {
+            consumed = position;
+            return fail(400);
+        }
+        if (c == '\r') {
+            saw_cr = true;
+            continue;
+        }
+
+        switch (state) {
+            case State::ChunkSize:
+                if (c == '\n') {
+                    if (!saw_digit) {
+                        consumed = position;
+                        return fail(400);
+                    }
+                    state = remaining > 0 ? State::Data : State::Trailer;
+                    line_bytes = 0;
+                    saw_digit = false;
+                } else if (c == ';' || c == ' ' || c == '\t') {
+                    state = State::ChunkExtension;
+                } else {
+                    int digit = (c >= '0' && c <= '9') ? c - '0' :
+                                (c >= 'a' && c <= 'f') ? c - 'a' + 10 :
+                                (c >= 'A' && c <= 'F') ? c - 'A' + 10 : -1;
+                    if (digit < 0 || remaining > (UINT64_MAX >> 4)) {
+                        consumed = position;
+                        return fail(400);
+                    }
+                    remaining = (remaining << 4) | static_cast<uint64_t>(digit);
+                    saw_digit = true;
+                }
+                break;
+
+            case State::ChunkExtension:
+                // Extensions are ignored
+                if (c == '\n') {
+                    if (!saw_digit) {
+                        consumed = position;
+                        return fail(400);
+                    }
+                    state = remaining > 0 ? State::Data : State::Trailer;
+                    line_bytes = 0;
+                    saw_digit = false;
+                }
+                break;
+
+            case State::ChunkDataEnd:
+                if (c != '\n') {
+                    consumed = position;
+                    return fail(400);
+                }
+                state = State::ChunkSize;
+                line_bytes = 0;
+                break;
+
+            case State::Trailer:
+                // Trailer fields are skipped; an empty line ends the message
+                if (c == '\n') {
+                    if (line_bytes == 0) {
+                        state = State::Done;
+                    }
+                    line_bytes = 0;
+                } else {
+                    line_bytes++;
+                }
+                if (++trailer_bytes > kMaxTrailerBytes) {
+                    consumed = position;
+                    return fail(400);
+                }
+                break;
+
+            default:
+                break;
+        }
+        saw_cr = false;
+        if ((state == State::ChunkSize || state == State::ChunkExtension) && ++line_bytes > kMaxChunkLineBytes) {
+            consumed = position;
+            return fail(400);
+        }
+    }
+
+    consumed = position;
+    return status();
+}
+
+HttpBodyDecoder::Status HttpBodyDecoder::fail(int status) {
+    state = State::Error;
+    error_status = status;
+    return Status::Error;
+}
+
+// Digits only: no sign, no list ("5, 5"); anything else frames ambiguously
+bool HttpBodyDecoder::parseContentLength(std::string_view value, uint64_t& length) {
+    if (value.empty() || value.size() > 18) {
+        return false;
+    }
+    length = 0;
+    for (char c : value) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        length = length * 10 + static_cast<uint64_t>(c - '0');
+    }
+    return true;
+}
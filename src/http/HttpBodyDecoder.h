@@ -0,0 +1,66 @@
+#ifndef HTTP_BODY_DECODER_H
+#define HTTP_BODY_DECODER_H
+
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+#include "HttpRequestView.h"
+#include "HttpBodyHandler.h"
+
+// Push-style decoder for request body framing (RFC 9112 6): a
+// Content-Length body, a chunked body, or none.
+//
+// start() reads the framing from the request head; decode() is then called
+// with each run of bytes that follows it, as they are received. Body bytes
+// go to the handler as they are decoded, without being collected, and
+// decode() reports how much of the input belonged to the body so that the
+// rest (a pipelined request) can be kept for the next parse.
+class HttpBodyDecoder {
+public:
+    enum class Framing { None, ContentLength, Chunked };
+    enum class Status { NeedMore, Complete, Error };
+
+    static constexpr size_t kMaxChunkLineBytes = 4 * 1024;  // Size line with extensions
+    static constexpr size_t kMaxTrailerBytes = 8 * 1024;
+
+    // Picks the framing from the request head and starts over. false, with
+    // errorStatus() set, if the body can't be framed: conflicting or invalid
+    // lengths (400) or a transfer coding other than chunked (501).
+    bool start(const HttpRequestView& request);
+
+    // Decodes the next bytes of the message. `consumed` is set to how many
+    // of them were body framing; all of them unless the body ended in
+    // `input`. A null handler discards the body. Stops with Error if the
+    // handler refuses data (errorStatus() is 0) or the chunking is malformed.
+    Status decode(std::string_view input, size_t& consumed, HttpBodyHandler* handler);
+
+    Framing framing() const { return body_framing; }
+    bool hasBody() const { return body_framing != Framing::None; }
+    // Declared length of a Content-Length body
+    uint64_t contentLength() const { return content_length; }
+    // Body bytes decoded so far
+    uint64_t bodyBytes() const { return body_bytes; }
+    Status status() const { return state == State::Done ? Status::Complete :
+                                   state == State::Error ? Status::Error : Status::NeedMore; }
+    int errorStatus() const { return error_status; }
+
+private:
+    enum class State { Data, ChunkSize, ChunkExtension, ChunkDataEnd, Trailer, Done, Error };
+
+    Framing body_framing = Framing::None;
+    State state = State::Done;
+    uint64_t content_length = 0;
+    uint64_t remaining = 0;       // Data bytes left in the body or the current chunk
+    uint64_t body_bytes = 0;
+    size_t line_bytes = 0;        // Length of the size or trailer line so far
+    size_t trailer_bytes = 0;
+    bool saw_digit = false;
+    bool saw_cr = false;
+    int error_status = 0;
+
+    Status fail(int status);
+
+    static bool parseContentLength(std::string_view value, uint64_t& length);
+};
+
+#endif // HTTP_BODY_DECODER_H
@@ -0,0 +1,28 @@
+#ifndef HTTP_BODY_HANDLER_H
+#define HTTP_BODY_HANDLER_H
+
+#include <string_view>
+#include "HttpResponse.h"
+
+// Consumes one request body as it arrives. The server hands over each piece
+// straight from its read buffer, so a handler must copy or write out what it
+// keeps; nothing else holds the whole body.
+class HttpBodyHandler
+{
+    public:
+        virtual ~HttpBodyHandler() = default;
+
+        // Next piece of the decoded body. false stops reading; the server then
+        // sends onBodyError() and closes the connection.
+        virtual bool onBodyData(std::string_view data) = 0;
+
+        // The whole body arrived: the response for the request
+        virtual HttpResponse onBodyComplete() = 0;
+
+        // The body was refused by onBodyData(), malformed or cut short: the
+        // response to send, if the connection is still usable. Any partial
+        // result must be discarded.
+        virtual HttpResponse onBodyError() = 0;
+};
+
+#endif // HTTP_BODY_HANDLER_H
@@ -0,0 +1,129 @@
+#include "HttpDate.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+// The shared copy and the thread that refreshes it. A function-local static,
+// so it is created on first use and the thread is joined at exit.
+class DateClock {
+public:
+    DateClock() {
+        HttpDate::format(std::time(nullptr), text);
+        generation.store(1, std::memory_order_release);
+        timer_thread = std::thread(&DateClock::timerLoop, this);
+    }
+
+    ~DateClock() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+        }
+        wake.notify_all();
+        timer_thread.join();
+    }
+
+    DateClock(const DateClock&) = delete;
+    DateClock& operator=(const DateClock&) = delete;
+
+    uint64_t currentGeneration() const {
+        return generation.load(std::memory_order_acquire);
+    }
+
+    // Copies the text and returns the generation it belongs to
+    uint64_t copy(char* out) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::memcpy(out, text, HttpDate::kLength);
+        return generation.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable wake;
+    char text[HttpDate::kLength];
+    std::atomic<uint64_t> generation{0};
+    bool running = true;
+    std::thread timer_thread;
+
+    // Wakes just after each second boundary, so the text is at most a few
+    // milliseconds behind the clock
+    void timerLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (running) {
+            auto next = std::chrono::time_point_cast<std::chrono::seconds>(std::chrono::system_clock::now()) +
+                        std::chrono::seconds(1);
+            wake.wait_until(lock, next, [this] { return !running; });
+            if (!running) {
+                break;
+            }
+            char updated[HttpDate::kLength];
+            HttpDate::format(std::time(nullptr), updated);
+            if (std::memcmp(updated, text, HttpDate::kLength) != 0) {
+                std::memcpy(text, updated, HttpDate::kLength);
+                generation.fetch_add(1, std::memory_order_release);
+            }
+        }
+    }
+};
+
+DateClock& dateClock() {
+    static DateClock clock;
+    return clock;
+}
+
+void appendTwoDigits(char*& out, int value) {
+    *out++ = static_cast<char>('0' + value / 10);
+    *out++ = static_cast<char>('0' + value % 10);
+}
+
+} // namespace
+
+std::string_view HttpDate::now() {
+    thread_local uint64_t seen_generation = 0;
+    thread_local char local[kLength];
+
+    DateClock& clock = dateClock();
+    if (clock.currentGeneration() != seen_generation) {
+        seen_generation = clock.copy(local);
+    }
+    return std::string_view(local, kLength);
+}
+
+void HttpDate::start() {
+    dateClock();
+}
+
+// Formatted by hand: strftime depends on the locale, and the names must be
+// the English ones whatever it is
+void HttpDate::format(std::time_t time, char* out) {
+    static constexpr char kDays[] = "SunMonTueWedThuFriSat";
+    static constexpr char kMonths[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+    std::tm utc{};
+    gmtime_r(&time, &utc);
+
+    std::memcpy(out, kDays + 3 * utc.tm_wday, 3);
+    out += 3;
+    *out++ = ',';
+    *out++ = ' ';
+    appendTwoDigits(out, utc.tm_mday);
+    *out++ = ' ';
+    std::memcpy(out, kMonths + 3 * utc.tm_mon, 3);
+    out += 3;
+    *out++ = ' ';
+    int year = utc.tm_year + 1900;
+    appendTwoDigits(out, year / 100 % 100);
+    appendTwoDigits(out, year % 100);
+    *out++ = ' ';
+    appendTwoDigits(out, utc.tm_hour);
+    *out++ = ':';
+    appendTwoDigits(out, utc.tm_min);
+    *out++ = ':';
+    appendTwoDigits(out, utc.tm_sec);
+    std::memcpy(out, " GMT", 4);
+}
@@ -0,0 +1,31 @@
+#ifndef HTTP_DATE_H
+#define HTTP_DATE_H
+
+#include <string_view>
+#include <ctime>
+#include <cstddef>
+
+// The Date header value, an IMF-fixdate such as
+// "Sun, 06 Nov 1994 08:49:37 GMT" (RFC 9110 5.6.7).
+//
+// A timer thread formats it once a second into a shared buffer and bumps a
+// generation counter. Each thread keeps its own copy and refreshes it only
+// when the generation has moved, so now() is an atomic load and a compare on
+// the hot path, never a gmtime/strftime call or a heap allocation.
+class HttpDate {
+public:
+    static constexpr size_t kLength = 29;
+
+    // The current date. The view is into a thread-local copy and stays valid
+    // on this thread until its next call.
+    static std::string_view now();
+
+    // Starts the timer thread if it is not running yet (now() does too, this
+    // just keeps the first request from paying for it)
+    static void start();
+
+    // Writes `time` as an IMF-fixdate to `out`, which holds kLength bytes
+    static void format(std::time_t time, char* out);
+};
+
+#endif // HTTP_DATE_H
@@ -0,0 +1,112 @@
+#ifndef HTTP_HEADERS_H
+#define HTTP_HEADERS_H
+
+#include <string_view>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Headers the server acts on. The parser resolves each header name to one of
+// these once, so request code checks them by slot instead of by name.
+enum class HttpHeader : uint8_t {
+    Host,
+    Connection,
+    AcceptEncoding,
+    IfNoneMatch,
+    Range,
+    ContentLength,
+    TransferEncoding,
+    Expect,
+    Other  // Not well known; also the number of slots
+};
+
+constexpr size_t kWellKnownHeaderCount = static_cast<size_t>(HttpHeader::Other);
+
+class HttpHeaderNames {
+public:
+    static constexpr std::string_view name(HttpHeader header) {
+        return kNames[static_cast<size_t>(header)];
+    }
+
+    // Well-known header for `name` (any case), or Other. A compile-time
+    // perfect hash picks the only candidate, so this is one table load and
+    // at most one comparison.
+    static constexpr HttpHeader lookup(std::string_view name) {
+        if (name.empty()) {
+            return HttpHeader::Other;
+        }
+        HttpHeader candidate = kTable[hash(name)];
+        if (candidate != HttpHeader::Other && equalsIgnoreCase(name, kNames[static_cast<size_t>(candidate)])) {
+            return candidate;
+        }
+        return HttpHeader::Other;
+    }
+
+    static constexpr char toLower(char c) {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+    }
+
+    static constexpr bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); i++) {
+            if (toLower(a[i]) != toLower(b[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static constexpr bool containsIgnoreCase(std::string_view text, std::string_view needle) {
+        for (size_t start = 0; start + needle.size() <= text.size(); start++) {
+            if (equalsIgnoreCase(text.substr(start, needle.size()), needle)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    static constexpr size_t kTableSize = 16;
+
+    static constexpr std::array<std::string_view, kWellKnownHeaderCount> kNames = {
+        "Host", "Connection", "Accept-Encoding", "If-None-Match", "Range", "Content-Length",
+        "Transfer-Encoding", "Expect"};
+
+    // Length plus lowercased first letter separates every well-known name
+    static constexpr size_t hash(std::string_view name) {
+        return (name.size() + static_cast<unsigned char>(toLower(name[0]))) % kTableSize;
+    }
+
+    static constexpr std::array<HttpHeader, kTableSize> buildTable() {
+        std::array<HttpHeader, kTableSize> table{};
+        for (auto& slot : table) {
+            slot = HttpHeader::Other;
+        }
+        for (size_t i = 0; i < kWellKnownHeaderCount; i++) {
+            table[hash(kNames[i])] = static_cast<HttpHeader>(i);
+        }
+        return table;
+    }
+
+    static const std::array<HttpHeader, kTableSize> kTable;
+};
+
+inline constexpr std::array<HttpHeader, HttpHeaderNames::kTableSize> HttpHeaderNames::kTable =
+    HttpHeaderNames::buildTable();
+
+constexpr bool isPerfectHeaderHash() {
+    for (size_t i = 0; i < kWellKnownHeaderCount; i++) {
+        HttpHeader header = static_cast<HttpHeader>(i);
+        if (HttpHeaderNames::lookup(HttpHeaderNames::name(header)) != header) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Adding a well-known header that collides needs a new hash()
+static_assert(isPerfectHeaderHash(), "well-known header names collide in HttpHeaderNames::hash");
+
+#endif // HTTP_HEADERS_H
@@ -0,0 +1,99 @@
+#ifndef HTTP_METHOD_H
+#define HTTP_METHOD_H
+
+#include <string_view>
+#include <cstdint>
+
+// Request methods and protocol versions. The parser resolves the request
+// line's tokens to these once, so validation, routing and keep-alive checks
+// switch on an enum instead of comparing strings per call.
+enum class HttpMethod : uint8_t {
+    Get,
+    Head,
+    Post,
+    Put,
+    Delete,
+    Options,
+    Connect,
+    Patch,
+    Trace,
+    Other  // Any other token
+};
+
+enum class HttpVersion : uint8_t {
+    Http10,
+    Http11,
+    Other  // HTTP/2.0 on an HTTP/1 connection, HTTP/0.9, malformed
+};
+
+class HttpMethodNames {
+public:
+    // Methods are case-sensitive (RFC 9110 9.1). The length and the first
+    // byte leave at most one candidate, so this is one comparison.
+    static constexpr HttpMethod lookup(std::string_view token) {
+        if (token.empty()) {
+            return HttpMethod::Other;
+        }
+        HttpMethod candidate = HttpMethod::Other;
+        switch (token.size()) {
+            case 3:
+                candidate = token[0] == 'G' ? HttpMethod::Get : token[0] == 'P' ? HttpMethod::Put : HttpMethod::Other;
+                break;
+            case 4:
+                candidate = token[0] == 'H' ? HttpMethod::Head : token[0] == 'P' ? HttpMethod::Post : HttpMethod::Other;
+                break;
+            case 5:
+                candidate = token[0] == 'P' ? HttpMethod::Patch : token[0] == 'T' ? HttpMethod::Trace : HttpMethod::Other;
+                break;
+            case 6:
+                candidate = HttpMethod::Delete;
+                break;
+            case 7:
+                candidate = token[0] == 'O' ? HttpMethod::Options : token[0] == 'C' ? HttpMethod::Connect : HttpMethod::Other;
+                break;
+            default:
+                break;
+        }
+        return candidate != HttpMethod::Other && token == name(candidate) ? candidate : HttpMethod::Other;
+    }
+
+    static constexpr std::string_view name(HttpMethod method) {
+        switch (method) {
+            case HttpMethod::Get: return "GET";
+            case HttpMethod::Head: return "HEAD";
+            case HttpMethod::Post: return "POST";
+            case HttpMethod::Put: return "PUT";
+            case HttpMethod::Delete: return "DELETE";
+            case HttpMethod::Options: return "OPTIONS";
+            case HttpMethod::Connect: return "CONNECT";
+            case HttpMethod::Patch: return "PATCH";
+            case HttpMethod::Trace: return "TRACE";
+            default: return "";
+        }
+    }
+
+    // The methods the server accepts at all; others get 400
+    static constexpr bool isSupported(HttpMethod method) {
+        switch (method) {
+            case HttpMethod::Get:
+            case HttpMethod::Head:
+            case HttpMethod::Post:
+            case HttpMethod::Put:
+            case HttpMethod::Delete:
+            case HttpMethod::Options:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // Exactly "HTTP/1.0" or "HTTP/1.1" (the name is case-sensitive too)
+    static constexpr HttpVersion lookupVersion(std::string_view token) {
+        if (token.size() != 8 || token.substr(0, 7) != "HTTP/1.") {
+            return HttpVersion::Other;
+        }
+        return token[7] == '1' ? HttpVersion::Http11 : token[7] == '0' ? HttpVersion::Http10 : HttpVersion::Other;
+    }
+};
+
+#endif // HTTP_METHOD_H
@@ -2,8 +2,9 @@
 #define HTTP_PARSER_H
 
 #include <string>
-#include <vector>
+#include <string_view>
 #include "HttpRequest.h"
+#include "HttpRequestView.h"
 
 // Example HTTP request
 /*
@@ -37,17 +38,18 @@
 
 class HttpParser{
     public:
-        // Parsing method
+        // One-shot parse of a complete request without allocating: fills
+        // `request` with slices of `raw_request`. Lines may end in CRLF or a
+        // bare LF; headers end at the first empty line (or the end of the
+        // input) and the rest is the body. Returns false for a malformed or
+        // oversized request head. Use HttpRequestParser when the request
+        // arrives over several reads.
+        static bool parse(std::string_view raw_request, HttpRequestView& request);
+
+        // Owning variant, for callers that keep the request beyond the buffer
         static HttpRequest parse(const std::string& raw_request);
 
         //Validation method
         static bool isValidHttpRequest(const std::string& raw_request);
-
-    private:
-        // Helper methods
-        static std::vector<std::string> splitLines(const std::string& text);
-        static std::pair<std::string, std::string> parseRequestLine(const std::string& line);
-        static std::string trim(const std::string& str);
-        static std::string toLowerCase(const std::string& str);
     };
 #endif // HTTP_PARSER_H
\ No newline at end of file
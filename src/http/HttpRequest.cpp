@@ -1,39 +1,69 @@
 #include "HttpRequest.h"
-#include <algorithm>
 #include <sstream>
 
-HttpRequest::HttpRequest() : method(""), path(""), version("HTTP/1.1") {
+HttpRequest::HttpRequest(allocator_type allocator)
+    : method(allocator), path(allocator), version("HTTP/1.1", allocator), headers(allocator), body(allocator) {
 }
 
-HttpRequest::HttpRequest(const std::string& method, const std::string& path) 
-    : method(method), path(path), version("HTTP/1.1") {
+HttpRequest::HttpRequest(std::string_view method, std::string_view path, allocator_type allocator)
+    : method(method, allocator), path(path, allocator), version("HTTP/1.1", allocator),
+      method_id(HttpMethodNames::lookup(method)), headers(allocator), body(allocator) {
 }
 
-std::string HttpRequest::getHeader(const std::string& name) const {
-    auto it = headers.find(name);
-    if (it != headers.end()) {
-        return it->second;
+// Well-known headers by slot, the rest by a scan of the flat list
+const HttpHeaderEntry* HttpRequest::findHeader(std::string_view name) const {
+    HttpHeader known = HttpHeaderNames::lookup(name);
+    if (known != HttpHeader::Other) {
+        uint32_t index = well_known[static_cast<size_t>(known)];
+        return index ? &headers[index - 1] : nullptr;
     }
-    return "";
+    for (const auto& header : headers) {
+        if (HttpHeaderNames::equalsIgnoreCase(header.name, name)) {
+            return &header;
+        }
+    }
+    return nullptr;
+}
+
+std::string_view HttpRequest::getHeader(std::string_view name) const {
+    const HttpHeaderEntry* header = findHeader(name);
+    return header ? std::string_view(header->value) : std::string_view();
+}
+
+std::string_view HttpRequest::getHeader(HttpHeader header) const {
+    uint32_t index = well_known[static_cast<size_t>(header)];
+    return index ? std::string_view(headers[index - 1].value) : std::string_view();
+}
+
+void HttpRequest::setHeader(std::string_view name, std::string_view value) {
+    const HttpHeaderEntry* existing = findHeader(name);
+    if (existing) {
+        headers[existing - headers.data()].value = value;
+        return;
+    }
+    addHeader(name, value);
 }
 
-void HttpRequest::setHeader(const std::string& name, const std::string& value) {
-    headers[name] = value;
+void HttpRequest::addHeader(std::string_view name, std::string_view value) {
+    HttpHeader known = HttpHeaderNames::lookup(name);
+    headers.push_back({std::pmr::string(name, headers.get_allocator()), std::pmr::string(value, headers.get_allocator())});
+    if (known != HttpHeader::Other && well_known[static_cast<size_t>(known)] == 0) {
+        well_known[static_cast<size_t>(known)] = static_cast<uint32_t>(headers.size());
+    }
 }
 
-bool HttpRequest::hasHeader(const std::string& name) const {
-    return headers.find(name) != headers.end();
+bool HttpRequest::hasHeader(std::string_view name) const {
+    return findHeader(name) != nullptr;
 }
 
 bool HttpRequest::isValid() const {
     // Basic validation
-    if (method.empty() || path.empty()) {
+    if (path.empty()) {
         return false;
     }
     
     // Valid HTTP methods
-    if (method != "GET" && method != "POST" && method != "PUT" && 
-        method != "DELETE" && method != "HEAD" && method != "OPTIONS") {
+    if (!HttpMethodNames::isSupported(method_id)) {
         return false;
     }
     
@@ -55,7 +85,7 @@ std::string HttpRequest::toString() const {
     
     oss << "Headers:" << std::endl;
     for (const auto& header : headers) {
-        oss << "  " << header.first << ": " << header.second << std::endl;
+        oss << "  " << header.name << ": " << header.value << std::endl;
     }
     
     if (!body.empty()) {
@@ -72,11 +102,10 @@ std::string HttpRequest::toString() const {
 
 bool HttpRequest::wantsKeepAlive() const{
     // Check Connection header for keep-alive
-    std::string connection = getHeader("Connection");
-    if(!connection.empty())
+    uint32_t connection = well_known[static_cast<size_t>(HttpHeader::Connection)];
+    if(connection && !headers[connection - 1].value.empty())
     {
-        std::transform(connection.begin(), connection.end(), connection.begin(), ::tolower);
-        return connection.find("keep-alive") != std::string::npos;
+        return HttpHeaderNames::containsIgnoreCase(headers[connection - 1].value, "keep-alive");
     }
 
     // Default to HTTP/1.1 keep-alive
@@ -87,6 +116,3 @@ bool HttpRequest::wantsKeepAlive() const{
     return false;
 }
 
-bool HttpRequest::isHttp11() const {
-    return version == "HTTP/1.1";
-}
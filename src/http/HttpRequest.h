@@ -2,51 +2,88 @@
 #define HTTP_REQUEST_H
 
 #include <string>
-#include <map>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <memory_resource>
+#include <cstdint>
 #include <iostream>
+#include "HttpHeaders.h"
+#include "HttpMethod.h"
 
+struct HttpHeaderEntry
+{
+    std::pmr::string name;
+    std::pmr::string value;
+};
+
+// Owning request. All of its strings come from one memory resource, e.g. a
+// connection's RequestArena; copies go to the default (heap) resource.
+// Getters return views into the request.
 class HttpRequest {
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
 private:
-    std::string method;      // GET, POST, PUT, DELETE
-    std::string path;        // /index.html or /api/resource
-    std::string version;     // HTTP/1.1
-    std::map<std::string, std::string> headers;  // Host, User-Agent, etc.
-    std::string body;        // Request body (for POST/PUT)
+    std::pmr::string method;      // GET, POST, PUT, DELETE
+    std::pmr::string path;        // /index.html or /api/resource
+    std::pmr::string version;     // HTTP/1.1
+    HttpMethod method_id = HttpMethod::Other;      // method, resolved when set
+    HttpVersion version_id = HttpVersion::Http11;  // version, resolved when set
+    std::pmr::vector<HttpHeaderEntry> headers;  // Host, User-Agent, etc., in arrival order
+    std::array<uint32_t, kWellKnownHeaderCount> well_known{};  // Index + 1 into headers; 0 if absent
+    std::pmr::string body;        // Request body (for POST/PUT)
 
 public:
     // Constructors
-    HttpRequest();
-    HttpRequest(const std::string& method, const std::string& path);
+    explicit HttpRequest(allocator_type allocator = {});
+    HttpRequest(std::string_view method, std::string_view path, allocator_type allocator = {});
     
     // Getters
-    std::string getMethod() const { return method; }
-    std::string getPath() const { return path; }
-    std::string getVersion() const { return version; }
-    std::string getBody() const { return body; }
-    std::string getHeader(const std::string& name) const;
-    const std::map<std::string, std::string>& getHeaders() const { return headers; }
+    std::string_view getMethod() const { return method; }
+    std::string_view getPath() const { return path; }
+    std::string_view getVersion() const { return version; }
+    HttpMethod getMethodId() const { return method_id; }
+    HttpVersion getVersionId() const { return version_id; }
+    std::string_view getBody() const { return body; }
+    // Header names are case-insensitive; the first of repeated headers wins
+    std::string_view getHeader(std::string_view name) const;
+    std::string_view getHeader(HttpHeader header) const;
+    const std::pmr::vector<HttpHeaderEntry>& getHeaders() const { return headers; }
+    allocator_type get_allocator() const { return method.get_allocator(); }
     
     // Setters
-    void setMethod(const std::string& method) { this->method = method; }
-    void setPath(const std::string& path) { this->path = path; }
-    void setVersion(const std::string& version) { this->version = version; }
-    void setBody(const std::string& body) { this->body = body; }
-    void setHeader(const std::string& name, const std::string& value);
+    void setMethod(std::string_view method) {
+        this->method = method;
+        method_id = HttpMethodNames::lookup(method);
+    }
+    void setPath(std::string_view path) { this->path = path; }
+    void setVersion(std::string_view version) {
+        this->version = version;
+        version_id = HttpMethodNames::lookupVersion(version);
+    }
+    void setBody(std::string_view body) { this->body = body; }
+    void setHeader(std::string_view name, std::string_view value);  // Replaces
+    void addHeader(std::string_view name, std::string_view value);  // Appends
     
     // Utility methods
     bool isValid() const;
-    bool hasHeader(const std::string& name) const;
+    bool hasHeader(std::string_view name) const;
+    bool hasHeader(HttpHeader header) const { return well_known[static_cast<size_t>(header)] != 0; }
     std::string toString() const;  // For debugging
 
     // Keep-alive support
     bool wantsKeepAlive() const;
-    bool isHttp11() const;
+    bool isHttp11() const { return version_id == HttpVersion::Http11; }
     
     // HTTP method helpers
-    bool isGET() const { return method == "GET"; }
-    bool isPOST() const { return method == "POST"; }
-    bool isPUT() const { return method == "PUT"; }
-    bool isDELETE() const { return method == "DELETE"; }
+    bool isGET() const { return method_id == HttpMethod::Get; }
+    bool isPOST() const { return method_id == HttpMethod::Post; }
+    bool isPUT() const { return method_id == HttpMethod::Put; }
+    bool isDELETE() const { return method_id == HttpMethod::Delete; }
+
+private:
+    const HttpHeaderEntry* findHeader(std::string_view name) const;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,187 @@
+#include "HttpRequestParser.h"
+#include "HttpScanner.h"
+
+HttpRequestParser::Status HttpRequestParser::feed(std::string_view buffer, HttpRequestView& request) {
+    if (state == State::Complete || state == State::Error) {
+        return status();
+    }
+    rebase(buffer.data(), request);
+
+    while (true) {
+        size_t line_end = buffer.find('\n', scan_offset);
+        if (line_end == std::string_view::npos) {
+            scan_offset = buffer.size();
+            if (state == State::RequestLine && buffer.size() - line_start > kMaxRequestLineBytes) {
+                return fail(414);
+            }
+            if (buffer.size() > kMaxHeaderBytes) {
+                return fail(431);
+            }
+            return Status::NeedMore;
+        }
+
+        std::string_view line = buffer.substr(line_start, line_end - line_start);
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        line_start = scan_offset = line_end + 1;
+        if (state == State::RequestLine && line.size() > kMaxRequestLineBytes) {
+            return fail(414);
+        }
+        if (line_start > kMaxHeaderBytes) {
+            return fail(431);
+        }
+
+        Status line_status = parseLine(line, request);
+        if (line_status != Status::NeedMore) {
+            return line_status;
+        }
+    }
+}
+
+HttpRequestParser::Status HttpRequestParser::finish(std::string_view buffer, HttpRequestView& request) {
+    Status fed = feed(buffer, request);
+    if (fed != Status::NeedMore) {
+        return fed;
+    }
+
+    // Whatever follows the last line break is a final, unterminated line
+    std::string_view line = buffer.substr(line_start);
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+    line_start = scan_offset = buffer.size();
+    if (!line.empty()) {
+        Status line_status = parseLine(line, request);
+        if (line_status != Status::NeedMore) {
+            return line_status;
+        }
+    }
+    if (state == State::RequestLine) {
+        return fail(400);
+    }
+
+    state = State::Complete;
+    header_bytes = buffer.size();
+    return Status::Complete;
+}
+
+void HttpRequestParser::reset() {
+    state = State::RequestLine;
+    line_start = 0;
+    scan_offset = 0;
+    header_bytes = 0;
+    error_status = 0;
+    base = nullptr;
+}
+
+// The buffer moved (it grew): point the views parsed so far at the new copy
+void HttpRequestParser::rebase(const char* new_base, HttpRequestView& request) {
+    if (base && base != new_base) {
+        auto move = [&](std::string_view& view) {
+            if (!view.empty()) {
+                view = std::string_view(new_base + (view.data() - base), view.size());
+            }
+        };
+        move(request.method);
+        move(request.path);
+        move(request.version);
+        for (size_t i = 0; i < request.header_count; i++) {
+            move(request.headers[i].name);
+            move(request.headers[i].value);
+        }
+    }
+    base = new_base;
+}
+
+HttpRequestParser::Status HttpRequestParser::parseLine(std::string_view line, HttpRequestView& request) {
+    if (state == State::RequestLine) {
+        // Empty lines before the request line are ignored (RFC 9112 2.2)
+        if (line.empty()) {
+            return Status::NeedMore;
+        }
+        request.clear();
+        if (!parseRequestLine(line, request)) {
+            return fail(400);
+        }
+        state = State::Headers;
+        return Status::NeedMore;
+    }
+
+    if (line.empty()) {
+        state = State::Complete;
+        header_bytes = line_start;
+        return Status::Complete;
+    }
+    if (request.header_count == HttpRequestView::kMaxHeaders) {
+        return fail(431);
+    }
+    if (!parseHeaderLine(line, request)) {
+        return fail(400);
+    }
+    return Status::NeedMore;
+}
+
+HttpRequestParser::Status HttpRequestParser::fail(int status) {
+    state = State::Error;
+    error_status = status;
+    return Status::Error;
+}
+
+// "GET /index.html HTTP/1.1": a token method, then target and version
+bool HttpRequestParser::parseRequestLine(std::string_view line, HttpRequestView& request) {
+    const char* cursor = line.data();
+    const char* end = cursor + line.size();
+
+    skipSpaces(cursor, end);
+    request.method = std::string_view(cursor, HttpScanner::tokenLength(cursor, end - cursor));
+    cursor += request.method.size();
+    if (request.method.empty() || !skipSpaces(cursor, end)) {
+        return false;
+    }
+    request.path = std::string_view(cursor, HttpScanner::targetLength(cursor, end - cursor));
+    cursor += request.path.size();
+    if (!skipSpaces(cursor, end)) {
+        return false;
+    }
+    request.version = std::string_view(cursor, HttpScanner::targetLength(cursor, end - cursor));
+    cursor += request.version.size();
+    skipSpaces(cursor, end);
+    request.method_id = HttpMethodNames::lookup(request.method);
+    request.version_id = HttpMethodNames::lookupVersion(request.version);
+    return !request.version.empty() && cursor == end;
+}
+
+// A token name directly followed by ':', then a value without control characters
+bool HttpRequestParser::parseHeaderLine(std::string_view line, HttpRequestView& request) {
+    const char* cursor = line.data();
+    const char* end = cursor + line.size();
+
+    size_t name_length = HttpScanner::tokenLength(cursor, end - cursor);
+    if (name_length == 0 || cursor + name_length == end || cursor[name_length] != ':') {
+        return false;
+    }
+    std::string_view name(cursor, name_length);
+    cursor += name_length + 1;
+
+    skipSpaces(cursor, end);
+    std::string_view value(cursor, HttpScanner::fieldValueLength(cursor, end - cursor));
+    if (cursor + value.size() != end) {
+        return false;
+    }
+    while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) {
+        value.remove_suffix(1);
+    }
+
+    request.addHeader(name, value);
+    return true;
+}
+
+// Skip spaces and tabs; false if there were none
+bool HttpRequestParser::skipSpaces(const char*& cursor, const char* end) {
+    const char* start = cursor;
+    while (cursor < end && (*cursor == ' ' || *cursor == '\t')) {
+        cursor++;
+    }
+    return cursor != start;
+}
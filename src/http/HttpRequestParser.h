@@ -0,0 +1,60 @@
+#ifndef HTTP_REQUEST_PARSER_H
+#define HTTP_REQUEST_PARSER_H
+
+#include <string_view>
+#include <cstddef>
+#include "HttpRequestView.h"
+
+// Push-style request head parser that keeps its place across reads.
+//
+// feed() is called with everything received so far for the request, each
+// time more bytes arrive. Bytes already fed must not change, but the buffer
+// may move (e.g. a growing std::string); completed lines are never looked at
+// again and the search for the next line break resumes where it stopped, so
+// a client trickling in a request costs O(bytes), not O(bytes x reads).
+//
+// On Complete, `request` holds slices of the last buffer fed and
+// headerBytes() is the offset just past the empty line; anything after it
+// (a body, or a pipelined request) is left to the caller.
+class HttpRequestParser {
+public:
+    enum class Status { NeedMore, Complete, Error };
+
+    static constexpr size_t kMaxRequestLineBytes = 8 * 1024;   // 414 beyond this
+    static constexpr size_t kMaxHeaderBytes = 64 * 1024;       // 431 beyond this
+
+    Status feed(std::string_view buffer, HttpRequestView& request);
+
+    // The peer is done sending: the end of the input also ends the last
+    // line and the header block (how the one-shot HttpParser reads requests)
+    Status finish(std::string_view buffer, HttpRequestView& request);
+
+    // Start over for the next request
+    void reset();
+
+    Status status() const { return state == State::Complete ? Status::Complete :
+                                   state == State::Error ? Status::Error : Status::NeedMore; }
+    size_t headerBytes() const { return header_bytes; }
+    // HTTP status to answer an Error with: 400, 414 or 431
+    int errorStatus() const { return error_status; }
+
+private:
+    enum class State { RequestLine, Headers, Complete, Error };
+
+    State state = State::RequestLine;
+    size_t line_start = 0;    // First byte of the line being parsed
+    size_t scan_offset = 0;   // Where the search for its line break resumes
+    size_t header_bytes = 0;
+    int error_status = 0;
+    const char* base = nullptr;  // Buffer the views in the request point into
+
+    void rebase(const char* new_base, HttpRequestView& request);
+    Status parseLine(std::string_view line, HttpRequestView& request);
+    Status fail(int status);
+
+    static bool parseRequestLine(std::string_view line, HttpRequestView& request);
+    static bool parseHeaderLine(std::string_view line, HttpRequestView& request);
+    static bool skipSpaces(const char*& cursor, const char* end);
+};
+
+#endif // HTTP_REQUEST_PARSER_H
@@ -0,0 +1,119 @@
+#ifndef HTTP_REQUEST_VIEW_H
+#define HTTP_REQUEST_VIEW_H
+
+#include <string>
+#include <string_view>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "HttpHeaders.h"
+#include "HttpMethod.h"
+#include "HttpRequest.h"
+
+struct HttpHeaderView
+{
+    std::string_view name;
+    std::string_view value;
+};
+
+// Non-owning result of HttpParser: every field is a slice of the buffer the
+// request was parsed from, so parsing allocates nothing. The buffer must
+// outlive the view; toRequest() makes an owning HttpRequest when a request
+// has to be kept beyond that.
+class HttpRequestView {
+public:
+    static constexpr size_t kMaxHeaders = 64;
+
+    std::string_view method;
+    std::string_view path;
+    std::string_view version;
+    std::string_view body;
+    // method and version, resolved by the parser along with them
+    HttpMethod method_id = HttpMethod::Other;
+    HttpVersion version_id = HttpVersion::Other;
+    std::array<HttpHeaderView, kMaxHeaders> headers;
+    size_t header_count = 0;
+    // Index + 1 into headers of each well-known header's first occurrence,
+    // resolved as headers are added; 0 if absent
+    std::array<uint8_t, kWellKnownHeaderCount> well_known{};
+
+    void clear() {
+        method = path = version = body = std::string_view();
+        method_id = HttpMethod::Other;
+        version_id = HttpVersion::Other;
+        header_count = 0;
+        well_known.fill(0);
+    }
+
+    // Caller checks header_count < kMaxHeaders
+    void addHeader(std::string_view name, std::string_view value) {
+        headers[header_count++] = {name, value};
+        HttpHeader known = HttpHeaderNames::lookup(name);
+        if (known != HttpHeader::Other && well_known[static_cast<size_t>(known)] == 0) {
+            well_known[static_cast<size_t>(known)] = static_cast<uint8_t>(header_count);
+        }
+    }
+
+    // O(1); empty if absent
+    std::string_view getHeader(HttpHeader header) const {
+        uint8_t index = well_known[static_cast<size_t>(header)];
+        return index ? headers[index - 1].value : std::string_view();
+    }
+
+    bool hasHeader(HttpHeader header) const {
+        return well_known[static_cast<size_t>(header)] != 0;
+    }
+
+    // Header names are case-insensitive (RFC 9110); empty if absent
+    std::string_view getHeader(std::string_view name) const {
+        const HttpHeaderView* header = findHeader(name);
+        return header ? header->value : std::string_view();
+    }
+
+    bool hasHeader(std::string_view name) const {
+        return findHeader(name) != nullptr;
+    }
+
+    // Same rules as HttpRequest::isValid
+    bool isValid() const {
+        return HttpMethodNames::isSupported(method_id) && !path.empty() && path[0] == '/';
+    }
+
+    bool isHttp11() const { return version_id == HttpVersion::Http11; }
+
+    bool wantsKeepAlive() const {
+        std::string_view connection = getHeader(HttpHeader::Connection);
+        if (!connection.empty()) {
+            return HttpHeaderNames::containsIgnoreCase(connection, "keep-alive");
+        }
+        return isHttp11();
+    }
+
+    // Owning copy, allocated from `resource` (e.g. the connection's arena)
+    HttpRequest toRequest(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const {
+        HttpRequest request(method, path, resource);
+        request.setVersion(version);
+        for (size_t i = 0; i < header_count; i++) {
+            request.addHeader(headers[i].name, headers[i].value);
+        }
+        request.setBody(body);
+        return request;
+    }
+
+private:
+    const HttpHeaderView* findHeader(std::string_view name) const {
+        HttpHeader known = HttpHeaderNames::lookup(name);
+        if (known != HttpHeader::Other) {
+            uint8_t index = well_known[static_cast<size_t>(known)];
+            return index ? &headers[index - 1] : nullptr;
+        }
+        for (size_t i = 0; i < header_count; i++) {
+            if (HttpHeaderNames::equalsIgnoreCase(headers[i].name, name)) {
+                return &headers[i];
+            }
+        }
+        return nullptr;
+    }
+};
+
+#endif // HTTP_REQUEST_VIEW_H
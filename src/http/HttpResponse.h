@@ -0,0 +1,154 @@
+#ifndef HTTP_RESPONSE_H
+#define HTTP_RESPONSE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <memory_resource>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <cerrno>
+#include <climits>
+#include <limits>
+#include <system_error>
+#include <sys/uio.h>
+#include "SegmentedBuffer.h"
+
+// A response ready to go on the wire: the status line and headers as text,
+// optionally followed by a body held in segments (a cached file) that is
+// sent in place with writev instead of being copied into the text.
+// Generated pages keep their whole response, body included, in `head`.
+//
+// `head` may live in a per-request arena (see RequestArena); writeTo() takes
+// its scratch memory from the same resource.
+struct HttpResponse
+{
+    std::pmr::string head;
+    std::shared_ptr<const SegmentedBuffer> body;  // Keeps the cached file alive while sending
+
+    HttpResponse() = default;
+    // Empty, with `head` in `resource`: responses moved into it stay there
+    // instead of being copied (pmr allocators don't follow a move-assignment)
+    explicit HttpResponse(std::pmr::memory_resource* resource) : head(resource) {}
+    HttpResponse(const std::string& text) : head(text.data(), text.size()) {}
+    HttpResponse(const char* text) : head(text) {}
+    HttpResponse(std::pmr::string head, std::shared_ptr<const SegmentedBuffer> body)
+        : head(std::move(head)), body(std::move(body)) {}
+
+    size_t size() const
+    {
+        return head.size() + (body ? body->size() : 0);
+    }
+
+    // Replace any Connection header with the server's keep-alive decision
+    void setConnection(bool keep_alive, long timeout_seconds = 0, int max_requests = 0)
+    {
+        size_t headers_end = head.find("\r\n\r\n");
+        if (headers_end == std::pmr::string::npos) {
+            return;  // Malformed response
+        }
+
+        static constexpr std::string_view kConnection = "\r\nConnection: ";
+        size_t existing = head.find(kConnection);
+        if (existing != std::pmr::string::npos && existing < headers_end) {
+            size_t line_end = head.find("\r\n", existing + 2);
+            head.erase(existing, line_end - existing);
+            headers_end -= line_end - existing;
+        }
+
+        // Built on the stack: the head may be in an arena, temporaries would not be
+        static constexpr std::string_view kKeepAlive = "\r\nConnection: keep-alive\r\nKeep-Alive: timeout=";
+        static constexpr std::string_view kMax = ", max=";
+        static constexpr std::string_view kClose = "\r\nConnection: close";
+        static constexpr size_t kNumberBytes = std::numeric_limits<long>::digits10 + 2;  // Digits and sign
+        static constexpr size_t kLineBytes = kKeepAlive.size() + kMax.size() + 2 * kNumberBytes;
+        static_assert(kClose.size() <= kLineBytes, "Connection: close must fit the line buffer");
+
+        char line[kLineBytes];
+        size_t length = 0;
+        bool formatted = true;
+        auto append = [&](std::string_view text) {
+            std::memcpy(line + length, text.data(), text.size());
+            length += text.size();
+        };
+        auto appendNumber = [&](long value) {
+            auto result = std::to_chars(line + length, line + kLineBytes, value);
+            if (result.ec != std::errc()) {
+                formatted = false;
+                return;
+            }
+            length = static_cast<size_t>(result.ptr - line);
+        };
+        if (keep_alive) {
+            append(kKeepAlive);
+            appendNumber(timeout_seconds);
+            append(kMax);
+            appendNumber(max_requests);
+        } else {
+            append(kClose);
+        }
+        if (formatted) {
+            head.insert(headers_end, line, length);
+        }
+    }
+
+    // For HEAD: keep the status line and headers, Content-Length included,
+    // and drop whatever body follows them
+    void omitBody()
+    {
+        size_t headers_end = head.find("\r\n\r\n");
+        if (headers_end != std::pmr::string::npos) {
+            head.resize(headers_end + 4);
+        }
+        body.reset();
+    }
+
+    // iovecs for the bytes from `offset` to the end, e.g. to resume after a
+    // partial write
+    template<class IovecVector>
+    void appendIovecs(IovecVector& out, size_t offset = 0) const
+    {
+        if (offset < head.size()) {
+            out.push_back({const_cast<char*>(head.data()) + offset, head.size() - offset});
+            offset = 0;
+        } else {
+            offset -= head.size();
+        }
+        if (body) {
+            body->appendIovecs(out, offset);
+        }
+    }
+
+    // Writes the head and the body segments with writev, resuming after
+    // partial writes. Returns the bytes sent, or -1 on error.
+    ssize_t writeTo(int fd) const
+    {
+        const size_t total = size();
+        size_t sent = 0;
+        std::pmr::vector<iovec> iov(head.get_allocator());
+        while (sent < total) {
+            iov.clear();
+            appendIovecs(iov, sent);
+            ssize_t written = writev(fd, iov.data(), static_cast<int>(std::min<size_t>(iov.size(), IOV_MAX)));
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return -1;
+            }
+            sent += written;
+        }
+        return static_cast<ssize_t>(sent);
+    }
+
+    // Contiguous copy, for tests and debugging
+    std::string toString() const
+    {
+        std::string text(head.data(), head.size());
+        return body ? text + body->toString() : text;
+    }
+};
+
+#endif // HTTP_RESPONSE_H
@@ -0,0 +1,238 @@
+#include "HttpScanner.h"
+#include <cstdint>
+#include <string_view>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define HTTP_SCANNER_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+struct ByteClasses {
+    bool token[256];
+    bool target[256];
+    bool field_value[256];
+
+    // A byte is a tchar iff token_low[low nibble] & token_high[high nibble];
+    // tchars only have high nibbles 2..7, one bit each
+    unsigned char token_low[16];
+    unsigned char token_high[16];
+};
+
+constexpr ByteClasses makeByteClasses() {
+    ByteClasses classes{};
+    constexpr std::string_view specials = "!#$%&'*+-.^_`|~";
+    for (int c = 0; c < 256; c++) {
+        bool token = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                     (c != 0 && specials.find(static_cast<char>(c)) != std::string_view::npos);
+        classes.token[c] = token;
+        classes.target[c] = c > 0x20 && c != 0x7f;
+        classes.field_value[c] = (c >= 0x20 && c != 0x7f) || c == '\t';
+        if (token) {
+            classes.token_low[c & 0x0f] |= static_cast<unsigned char>(1 << ((c >> 4) - 2));
+            classes.token_high[c >> 4] = static_cast<unsigned char>(1 << ((c >> 4) - 2));
+        }
+    }
+    return classes;
+}
+
+constexpr ByteClasses kClasses = makeByteClasses();
+
+inline size_t scalarRun(const bool* table, const char* data, size_t size) {
+    size_t i = 0;
+    while (i < size && table[static_cast<unsigned char>(data[i])]) {
+        i++;
+    }
+    return i;
+}
+
+size_t scalarTokenLength(const char* data, size_t size) {
+    return scalarRun(kClasses.token, data, size);
+}
+
+size_t scalarTargetLength(const char* data, size_t size) {
+    return scalarRun(kClasses.target, data, size);
+}
+
+size_t scalarFieldValueLength(const char* data, size_t size) {
+    return scalarRun(kClasses.field_value, data, size);
+}
+
+#ifdef HTTP_SCANNER_X86
+
+// SSE4.2: PCMPESTRI finds the first byte inside a list of up to 8 ranges.
+// The ranges may cover more than the class excludes (tokens: '|' and '~' sit
+// inside '{'..0xff); such hits are checked against the table and skipped.
+__attribute__((target("sse4.2")))
+inline size_t sse42Run(__m128i stop_ranges, int ranges_length, const bool* table,
+                       const char* data, size_t size) {
+    size_t i = 0;
+    while (i + 16 <= size) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        int index = _mm_cmpestri(stop_ranges, ranges_length, chunk, 16,
+                                 _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_LEAST_SIGNIFICANT);
+        if (index == 16) {
+            i += 16;
+        } else if (!table[static_cast<unsigned char>(data[i + index])]) {
+            return i + index;
+        } else {
+            i += index + 1;
+        }
+    }
+    return i + scalarRun(table, data + i, size - i);
+}
+
+__attribute__((target("sse4.2")))
+size_t sse42TokenLength(const char* data, size_t size) {
+    alignas(16) static const char ranges[16] = {
+        '\x00', ' ', '"', '"', '(', ')', ',', ',', '/', '/', ':', '@', '[', ']', '{', '\xff'};
+    return sse42Run(_mm_load_si128(reinterpret_cast<const __m128i*>(ranges)), 16,
+                    kClasses.token, data, size);
+}
+
+__attribute__((target("sse4.2")))
+size_t sse42TargetLength(const char* data, size_t size) {
+    alignas(16) static const char ranges[16] = {'\x00', ' ', '\x7f', '\x7f'};
+    return sse42Run(_mm_load_si128(reinterpret_cast<const __m128i*>(ranges)), 4,
+                    kClasses.target, data, size);
+}
+
+__attribute__((target("sse4.2")))
+size_t sse42FieldValueLength(const char* data, size_t size) {
+    alignas(16) static const char ranges[16] = {'\x00', '\x08', '\x0a', '\x1f', '\x7f', '\x7f'};
+    return sse42Run(_mm_load_si128(reinterpret_cast<const __m128i*>(ranges)), 6,
+                    kClasses.field_value, data, size);
+}
+
+// AVX2: classify 32 bytes at a time into a stop mask; the first set bit is the end
+__attribute__((target("avx2")))
+size_t avx2TokenLength(const char* data, size_t size) {
+    const __m256i low_bits = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(kClasses.token_low)));
+    const __m256i high_bits = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(kClasses.token_high)));
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+
+    size_t i = 0;
+    while (i + 32 <= size) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i low = _mm256_shuffle_epi8(low_bits, _mm256_and_si256(chunk, nibble));
+        __m256i high = _mm256_shuffle_epi8(high_bits, _mm256_and_si256(_mm256_srli_epi16(chunk, 4), nibble));
+        __m256i stop = _mm256_cmpeq_epi8(_mm256_and_si256(low, high), _mm256_setzero_si256());
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(stop));
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+        i += 32;
+    }
+    return i + scalarRun(kClasses.token, data + i, size - i);
+}
+
+__attribute__((target("avx2")))
+size_t avx2TargetLength(const char* data, size_t size) {
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i del = _mm256_set1_epi8(0x7f);
+
+    size_t i = 0;
+    while (i + 32 <= size) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i up_to_space = _mm256_cmpeq_epi8(_mm256_min_epu8(chunk, space), chunk);
+        __m256i stop = _mm256_or_si256(up_to_space, _mm256_cmpeq_epi8(chunk, del));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(stop));
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+        i += 32;
+    }
+    return i + scalarRun(kClasses.target, data + i, size - i);
+}
+
+__attribute__((target("avx2")))
+size_t avx2FieldValueLength(const char* data, size_t size) {
+    const __m256i last_control = _mm256_set1_epi8(0x1f);
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i del = _mm256_set1_epi8(0x7f);
+
+    size_t i = 0;
+    while (i + 32 <= size) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(chunk, last_control), chunk);
+        __m256i stop = _mm256_or_si256(_mm256_andnot_si256(_mm256_cmpeq_epi8(chunk, tab), control),
+                                       _mm256_cmpeq_epi8(chunk, del));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(stop));
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+        i += 32;
+    }
+    return i + scalarRun(kClasses.field_value, data + i, size - i);
+}
+
+#endif // HTTP_SCANNER_X86
+
+} // namespace
+
+std::atomic<const HttpScanner::Dispatch*> HttpScanner::active_dispatch{
+    &HttpScanner::dispatchFor(HttpScanner::bestKernel())};
+
+const HttpScanner::Dispatch& HttpScanner::dispatchFor(Kernel kernel) {
+    static const Dispatch scalar{Kernel::Scalar, scalarTokenLength, scalarTargetLength, scalarFieldValueLength};
+#ifdef HTTP_SCANNER_X86
+    static const Dispatch sse42{Kernel::SSE42, sse42TokenLength, sse42TargetLength, sse42FieldValueLength};
+    static const Dispatch avx2{Kernel::AVX2, avx2TokenLength, avx2TargetLength, avx2FieldValueLength};
+    switch (kernel) {
+        case Kernel::AVX2: return avx2;
+        case Kernel::SSE42: return sse42;
+        case Kernel::Scalar: break;
+    }
+#else
+    (void)kernel;
+#endif
+    return scalar;
+}
+
+bool HttpScanner::isTokenChar(unsigned char c) {
+    return kClasses.token[c];
+}
+
+bool HttpScanner::isSupported(Kernel kernel) {
+#ifdef HTTP_SCANNER_X86
+    __builtin_cpu_init();
+    switch (kernel) {
+        case Kernel::AVX2: return __builtin_cpu_supports("avx2");
+        case Kernel::SSE42: return __builtin_cpu_supports("sse4.2");
+        case Kernel::Scalar: return true;
+    }
+    return false;
+#else
+    return kernel == Kernel::Scalar;
+#endif
+}
+
+HttpScanner::Kernel HttpScanner::bestKernel() {
+    if (isSupported(Kernel::AVX2)) {
+        return Kernel::AVX2;
+    }
+    if (isSupported(Kernel::SSE42)) {
+        return Kernel::SSE42;
+    }
+    return Kernel::Scalar;
+}
+
+const char* HttpScanner::kernelName(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::AVX2: return "AVX2";
+        case Kernel::SSE42: return "SSE4.2";
+        case Kernel::Scalar: return "scalar";
+    }
+    return "unknown";
+}
+
+bool HttpScanner::setKernel(Kernel kernel) {
+    if (!isSupported(kernel)) {
+        return false;
+    }
+    active_dispatch.store(&dispatchFor(kernel));
+    return true;
+}
@@ -0,0 +1,56 @@
+#ifndef HTTP_SCANNER_H
+#define HTTP_SCANNER_H
+
+#include <cstddef>
+#include <atomic>
+
+// Byte-class scanning for the request parser. Each scan returns the length of
+// the leading run of bytes in its class, so finding a delimiter and validating
+// everything before it take a single pass.
+//
+// The SSE4.2 and AVX2 kernels handle 16/32 bytes per step; the best one the
+// CPU supports is picked at startup, with a table-driven scalar fallback.
+// Vector loads never read past `size`: the tail is always done byte by byte.
+class HttpScanner {
+public:
+    enum class Kernel { Scalar, SSE42, AVX2 };
+
+    // RFC 9110 tchar run, e.g. a method or header name (stops at ':' or SP)
+    static size_t tokenLength(const char* data, size_t size) {
+        return active_dispatch.load(std::memory_order_relaxed)->token_length(data, size);
+    }
+
+    // Run of bytes other than SP and controls: a request target or version
+    static size_t targetLength(const char* data, size_t size) {
+        return active_dispatch.load(std::memory_order_relaxed)->target_length(data, size);
+    }
+
+    // Field value run: anything but controls other than HTAB, so it stops at
+    // the CR/LF ending the line or at a byte that makes the line invalid
+    static size_t fieldValueLength(const char* data, size_t size) {
+        return active_dispatch.load(std::memory_order_relaxed)->field_value_length(data, size);
+    }
+
+    static bool isTokenChar(unsigned char c);
+
+    static bool isSupported(Kernel kernel);
+    static Kernel bestKernel();
+    static Kernel activeKernel() { return active_dispatch.load()->kernel; }
+    static const char* kernelName(Kernel kernel);
+
+    // Switch kernels (benchmarks and tests); false if the CPU lacks it
+    static bool setKernel(Kernel kernel);
+
+private:
+    struct Dispatch {
+        Kernel kernel;
+        size_t (*token_length)(const char*, size_t);
+        size_t (*target_length)(const char*, size_t);
+        size_t (*field_value_length)(const char*, size_t);
+    };
+
+    static std::atomic<const Dispatch*> active_dispatch;
+    static const Dispatch& dispatchFor(Kernel kernel);
+};
+
+#endif // HTTP_SCANNER_H
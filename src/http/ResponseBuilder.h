@@ -0,0 +1,91 @@
+#ifndef RESPONSE_BUILDER_H
+#define RESPONSE_BUILDER_H
+
+#include <string>
+#include <string_view>
+#include <memory_resource>
+#include <charconv>
+#include <cstdint>
+#include "HttpDate.h"
+
+// Writes a response into a caller's string: status line, headers and an
+// optional body. The string is cleared and reserved once for the head plus
+// the body, numbers are formatted with to_chars on the stack and the Date
+// comes from HttpDate's cached copy, so building a response never makes
+// temporaries. With a std::pmr::string from the connection's arena the
+// buffer is reused from request to request.
+//
+//   ResponseBuilder(out, body.size()).status(200, "OK")
+//       .header("Content-Type", "text/html").standardHeaders().body(body);
+template<class String>
+class BasicResponseBuilder {
+public:
+    static constexpr size_t kHeadReserve = 256;
+    static constexpr std::string_view kServerName = "CustomHTTPServer/1.0";
+
+    explicit BasicResponseBuilder(String& out, size_t body_size = 0) : out(out) {
+        out.clear();
+        out.reserve(kHeadReserve + body_size);
+    }
+
+    BasicResponseBuilder& status(int code, std::string_view reason) {
+        out.append("HTTP/1.1 ");
+        appendNumber(static_cast<uint64_t>(code));
+        out.push_back(' ');
+        out.append(reason.data(), reason.size());
+        out.append("\r\n");
+        return *this;
+    }
+
+    BasicResponseBuilder& header(std::string_view name, std::string_view value) {
+        out.append(name.data(), name.size());
+        out.append(": ");
+        out.append(value.data(), value.size());
+        out.append("\r\n");
+        return *this;
+    }
+
+    BasicResponseBuilder& header(std::string_view name, uint64_t value) {
+        out.append(name.data(), name.size());
+        out.append(": ");
+        appendNumber(value);
+        out.append("\r\n");
+        return *this;
+    }
+
+    // Date, Server and Connection: close, which every response carries. The
+    // connection loop rewrites Connection with HttpResponse::setConnection.
+    BasicResponseBuilder& standardHeaders() {
+        header("Date", HttpDate::now());
+        header("Server", kServerName);
+        return header("Connection", "close");
+    }
+
+    // Ends the headers; what follows is the body, if any
+    BasicResponseBuilder& endHeaders() {
+        out.append("\r\n");
+        return *this;
+    }
+
+    // Content-Length, the end of the headers and the body itself
+    BasicResponseBuilder& body(std::string_view content) {
+        header("Content-Length", static_cast<uint64_t>(content.size()));
+        endHeaders();
+        out.append(content.data(), content.size());
+        return *this;
+    }
+
+private:
+    String& out;
+
+    void appendNumber(uint64_t value) {
+        char digits[20];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        out.append(digits, static_cast<size_t>(result.ptr - digits));
+    }
+};
+
+using ResponseBuilder = BasicResponseBuilder<std::string>;
+using PmrResponseBuilder = BasicResponseBuilder<std::pmr::string>;
+
+#endif // RESPONSE_BUILDER_H
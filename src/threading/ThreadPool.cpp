@@ -1,7 +1,7 @@
 #include "ThreadPool.h"
 #include <chrono>
 
-ThreadPool::ThreadPool(size_t num_threads) : stop_flag(false), active_threads(0), current_queue_size(0), total_tasks_processed(0), pool_size(num_threads) {
+ThreadPool::ThreadPool(size_t num_threads) : stop_flag(false), active_threads(0), current_queue_size(0), pool_size(num_threads) {
     std::cout << "[ThreadPool] Initializing with " << pool_size << " threads..." << std::endl;
    
     // Create worker threads
@@ -85,7 +85,7 @@ void ThreadPool::workerLoop()
 
                 task();
 
-                total_tasks_processed.fetch_add(1);
+                total_tasks_processed.add();
             }
             catch(const std::exception& e)
             {
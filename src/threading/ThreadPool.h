@@ -10,6 +10,7 @@
 #include <future>
 #include <atomic>
 #include <iostream>
+#include "StripedCounter.h"
 
 class ThreadPool {
     private:
@@ -26,7 +27,7 @@ class ThreadPool {
         std::atomic<size_t> active_threads;
 
         // Statistics
-        std::atomic<size_t> total_tasks_processed;
+        StripedCounter total_tasks_processed;  // Bumped by every worker, striped to avoid contention
         std::atomic<size_t> current_queue_size;
 
         // Poll size
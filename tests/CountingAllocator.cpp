@@ -0,0 +1,72 @@
+#include "CountingAllocator.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <malloc.h>
+
+// Kept in a translation unit of their own: when GCC can see a replacement
+// operator new and the free() in operator delete at the same call site it
+// reports them as mismatched (-Wmismatched-new-delete). Live bytes come from
+// malloc_usable_size, so no size prefix has to be stored in front of blocks.
+
+namespace {
+    thread_local size_t t_allocations = 0;
+    std::atomic<size_t> g_allocations{0};
+    std::atomic<size_t> g_live_bytes{0};
+
+    void* counted(void* block) {
+        t_allocations++;
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+        g_live_bytes.fetch_add(malloc_usable_size(block), std::memory_order_relaxed);
+        return block;
+    }
+
+    void release(void* ptr) noexcept {
+        if (ptr) {
+            g_live_bytes.fetch_sub(malloc_usable_size(ptr), std::memory_order_relaxed);
+            std::free(ptr);
+        }
+    }
+}
+
+size_t CountingAllocator::threadAllocations() {
+    return t_allocations;
+}
+
+size_t CountingAllocator::totalAllocations() {
+    return g_allocations.load(std::memory_order_relaxed);
+}
+
+size_t CountingAllocator::liveBytes() {
+    return g_live_bytes.load(std::memory_order_relaxed);
+}
+
+void* operator new(size_t size) {
+    void* block = std::malloc(size ? size : 1);
+    if (!block) {
+        throw std::bad_alloc();
+    }
+    return counted(block);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    void* block = nullptr;
+    size_t align = std::max(static_cast<size_t>(alignment), sizeof(void*));
+    if (posix_memalign(&block, align, size ? size : 1) != 0) {
+        throw std::bad_alloc();
+    }
+    return counted(block);
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new[](size_t size, std::align_val_t alignment) { return operator new(size, alignment); }
+
+void operator delete(void* ptr) noexcept { release(ptr); }
+void operator delete(void* ptr, size_t) noexcept { release(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { release(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { release(ptr); }
+void operator delete[](void* ptr) noexcept { release(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { release(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { release(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { release(ptr); }
@@ -0,0 +1,25 @@
+#ifndef COUNTING_ALLOCATOR_H
+#define COUNTING_ALLOCATOR_H
+
+#include <cstddef>
+
+// Heap counters kept by the replacement operator new/delete in
+// CountingAllocator.cpp, which every test binary that measures allocations
+// links in. The aligned forms are counted as well: they are what
+// std::pmr::new_delete_resource() uses, so memory resources spilling to the
+// heap show up too.
+class CountingAllocator
+{
+    public:
+        // Allocations made by the calling thread, so background threads
+        // (the cache's timers and watchers) don't disturb a measurement
+        static size_t threadAllocations();
+
+        // Allocations made by every thread
+        static size_t totalAllocations();
+
+        // Usable bytes of the blocks currently allocated
+        static size_t liveBytes();
+};
+
+#endif // COUNTING_ALLOCATOR_H
@@ -0,0 +1,144 @@
+#ifndef HTTP_CORPUS_H
+#define HTTP_CORPUS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "http/HttpRequestParser.h"
+#include "http/HttpBodyDecoder.h"
+
+// Requests captured from real clients (and a few known-bad ones) in
+// tests/corpus/http. The same files seed the fuzzer, are replayed by the
+// http_fuzz_replay test and drive the corpus benchmark, whose expected
+// outcomes are in tests/corpus/http.expected.
+struct CorpusRequest
+{
+    std::string name;
+    std::string wire;
+};
+
+inline std::vector<CorpusRequest> loadCorpus(const std::string& directory)
+{
+    std::vector<CorpusRequest> corpus;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        if (!entry.is_regular_file()) {
+            continue;
+        }
+        std::ifstream in(entry.path(), std::ios::binary);
+        std::ostringstream wire;
+        wire << in.rdbuf();
+        corpus.push_back({entry.path().filename().string(), wire.str()});
+    }
+    std::sort(corpus.begin(), corpus.end(),
+              [](const CorpusRequest& a, const CorpusRequest& b) { return a.name < b.name; });
+    return corpus;
+}
+
+// What the server makes of one message on the wire: the head, then the body
+// framing, the way Server::handleConnection reads them
+struct ParsedMessage
+{
+    enum : int { kComplete = 0, kIncomplete = -1 };
+
+    int status = kIncomplete;  // kComplete, kIncomplete or the error status sent
+    std::string_view method;
+    std::string_view target;
+    size_t headers = 0;
+    uint64_t body_bytes = 0;
+    size_t consumed = 0;       // Head and body; the next pipelined message starts here
+
+    bool operator==(const ParsedMessage& other) const
+    {
+        return status == other.status && method == other.method && target == other.target &&
+               headers == other.headers && body_bytes == other.body_bytes && consumed == other.consumed;
+    }
+
+    // One line of tests/corpus/http.expected
+    std::string summary() const
+    {
+        std::string line = status == kComplete ? "complete" :
+                           status == kIncomplete ? "incomplete" : std::to_string(status);
+        if (status == kComplete) {
+            line += " " + std::string(method) + " " + std::string(target) + " headers=" + std::to_string(headers) +
+                    " body=" + std::to_string(body_bytes) + " consumed=" + std::to_string(consumed);
+        }
+        return line;
+    }
+};
+
+// Parses the message at the start of `wire`, receiving it `piece` bytes at a
+// time (0: all at once). The views in `view` point into `wire`.
+inline ParsedMessage parseMessage(std::string_view wire, size_t piece, HttpRequestView& view,
+                                  HttpRequestParser& parser, HttpBodyDecoder& decoder)
+{
+    ParsedMessage result;
+    if (piece == 0) {
+        piece = wire.size() ? wire.size() : 1;
+    }
+
+    parser.reset();
+    HttpRequestParser::Status head = HttpRequestParser::Status::NeedMore;
+    for (size_t received = std::min(piece, wire.size()); ; received = std::min(received + piece, wire.size())) {
+        head = parser.feed(wire.substr(0, received), view);
+        if (head != HttpRequestParser::Status::NeedMore || received == wire.size()) {
+            break;
+        }
+    }
+    if (head == HttpRequestParser::Status::NeedMore) {
+        return result;
+    }
+    if (head == HttpRequestParser::Status::Error || !view.isValid()) {
+        result.status = head == HttpRequestParser::Status::Error ? parser.errorStatus() : 400;
+        return result;
+    }
+    if (!decoder.start(view)) {
+        result.status = decoder.errorStatus();
+        return result;
+    }
+
+    size_t position = parser.headerBytes();
+    HttpBodyDecoder::Status body = decoder.status();
+    while (body == HttpBodyDecoder::Status::NeedMore && position < wire.size()) {
+        size_t consumed = 0;
+        body = decoder.decode(wire.substr(position, piece), consumed, nullptr);
+        position += consumed;
+    }
+    if (body == HttpBodyDecoder::Status::Error) {
+        result.status = 400;
+        return result;
+    }
+    if (body == HttpBodyDecoder::Status::Complete) {
+        result.status = ParsedMessage::kComplete;
+    }
+    result.method = view.method;
+    result.target = view.path;
+    result.headers = view.header_count;
+    result.body_bytes = decoder.bodyBytes();
+    result.consumed = position;
+    return result;
+}
+
+// Every message in `wire`, pipelined one after another, up to the first
+// that is incomplete or rejected (the server stops reading there)
+inline std::vector<ParsedMessage> parseMessages(std::string_view wire, size_t piece, HttpRequestView& view,
+                                                HttpRequestParser& parser, HttpBodyDecoder& decoder)
+{
+    std::vector<ParsedMessage> messages;
+    size_t offset = 0;
+    while (true) {
+        ParsedMessage message = parseMessage(wire.substr(offset), piece, view, parser, decoder);
+        message.consumed += message.status == ParsedMessage::kComplete ? offset : 0;
+        messages.push_back(message);
+        if (message.status != ParsedMessage::kComplete || message.consumed == wire.size()) {
+            return messages;
+        }
+        offset = message.consumed;
+    }
+}
+
+#endif // HTTP_CORPUS_H
@@ -0,0 +1,415 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <cmath>
+#include <iomanip>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <sstream>
+#include "cache/CacheSimulator.h"
+#include "cache/FileCache.h"
+#include "CountingAllocator.h"
+
+// The cache layout before slot arrays: an unordered_map of shared_ptr nodes
+// chained into a doubly linked LRU list through shared_ptr prev/next. Kept
+// here only as the baseline for the layout benchmarks.
+class LegacyLRUFileCache
+{
+    private:
+        struct CacheNode
+        {
+            std::string key;
+            std::shared_ptr<const CachedFile> file;
+            std::shared_ptr<CacheNode> prev;
+            std::shared_ptr<CacheNode> next;
+
+            CacheNode(const std::string& key, std::shared_ptr<const CachedFile> file)
+                : key(key), file(std::move(file)) {}
+        };
+
+        std::unordered_map<std::string, std::shared_ptr<CacheNode>> cache_map;
+        std::shared_ptr<CacheNode> head;
+        std::shared_ptr<CacheNode> tail;
+        size_t capacity_bytes;
+        size_t current_size_bytes;
+        std::shared_mutex cache_mutex;
+
+    public:
+        explicit LegacyLRUFileCache(size_t capacity_bytes)
+            : capacity_bytes(capacity_bytes), current_size_bytes(0)
+        {
+            head = std::make_shared<CacheNode>("head", nullptr);
+            tail = std::make_shared<CacheNode>("tail", nullptr);
+            head->next = tail;
+            tail->prev = head;
+        }
+
+        ~LegacyLRUFileCache()
+        {
+            // Break the prev/next cycles
+            for (auto node = head; node; ) {
+                auto next = node->next;
+                node->prev.reset();
+                node->next.reset();
+                node = next;
+            }
+        }
+
+        std::shared_ptr<const CachedFile> get(const std::string& key)
+        {
+            std::unique_lock<std::shared_mutex> lock(cache_mutex);
+            auto it = cache_map.find(key);
+            if (it == cache_map.end()) {
+                return nullptr;
+            }
+            auto node = it->second;
+            unlink(node);
+            addToFront(node);
+            return node->file;
+        }
+
+        void put(const std::string& key, std::shared_ptr<const CachedFile> file)
+        {
+            std::unique_lock<std::shared_mutex> lock(cache_mutex);
+            while (current_size_bytes + file->size_bytes > capacity_bytes && !cache_map.empty()) {
+                auto victim = tail->prev;
+                unlink(victim);
+                current_size_bytes -= victim->file->size_bytes;
+                cache_map.erase(victim->key);
+            }
+            auto node = std::make_shared<CacheNode>(key, file);
+            current_size_bytes += file->size_bytes;
+            cache_map[key] = node;
+            addToFront(node);
+        }
+
+    private:
+        void unlink(const std::shared_ptr<CacheNode>& node)
+        {
+            node->prev->next = node->next;
+            node->next->prev = node->prev;
+        }
+
+        void addToFront(const std::shared_ptr<CacheNode>& node)
+        {
+            node->next = head->next;
+            node->prev = head;
+            head->next->prev = node;
+            head->next = node;
+        }
+};
+
+class CacheBenchmark : public ::testing::Test {
+    protected:
+        // The cache logs every operation; keep that out of the measurements.
+        // A muted stream still formats each line, so the per-operation lines
+        // are switched off as well: they cost more than the lookups.
+        struct MuteCacheLog {
+            std::streambuf* saved = std::cout.rdbuf(nullptr);
+            MuteCacheLog() { LRUFileCache::setOperationLogging(false); }
+            ~MuteCacheLog() {
+                LRUFileCache::setOperationLogging(true);
+                std::cout.rdbuf(saved);
+            }
+        };
+
+        static std::vector<std::string> makeKeys(size_t count) {
+            std::vector<std::string> keys;
+            keys.reserve(count);
+            for (size_t i = 0; i < count; i++) {
+                keys.push_back("/f/" + std::to_string(i));
+            }
+            return keys;
+        }
+
+        // Zipf(0.9) key ids, generated up front so the timed loops only touch the cache
+        static std::vector<size_t> makeZipfIds(size_t requests, size_t objects) {
+            std::mt19937 rng(7);
+            std::vector<double> weights(objects);
+            for (size_t i = 0; i < objects; i++) {
+                weights[i] = 1.0 / std::pow(static_cast<double>(i + 1), 0.9);
+            }
+            std::discrete_distribution<size_t> popularity(weights.begin(), weights.end());
+            std::vector<size_t> ids(requests);
+            for (auto& id : ids) {
+                id = popularity(rng);
+            }
+            return ids;
+        }
+
+        template<class Cache>
+        static double opsPerSecond(Cache& cache, const std::vector<std::string>& keys,
+                                   const std::vector<size_t>& ids,
+                                   const std::shared_ptr<const CachedFile>& file) {
+            auto start = std::chrono::steady_clock::now();
+            for (size_t id : ids) {
+                if (!cache.get(keys[id])) {
+                    cache.put(keys[id], file);
+                }
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            return ids.size() / seconds;
+        }
+
+        // Zipf-distributed site traffic over `objects` files, interrupted every
+        // `scan_every` requests by a crawler walking `scan_length` cold files once.
+        std::vector<TraceRecord> buildScanTrace(size_t requests, size_t objects,
+                                                size_t scan_every, size_t scan_length) {
+            std::mt19937 rng(42);
+            std::uniform_int_distribution<size_t> size_dist(2 * 1024, 100 * 1024);
+
+            std::vector<size_t> sizes(objects);
+            std::vector<double> weights(objects);
+            for (size_t i = 0; i < objects; i++) {
+                sizes[i] = size_dist(rng);
+                weights[i] = 1.0 / std::pow(static_cast<double>(i + 1), 0.9);
+            }
+            std::discrete_distribution<size_t> popularity(weights.begin(), weights.end());
+
+            std::vector<TraceRecord> trace;
+            trace.reserve(requests);
+            size_t cold_id = 0;
+            while (trace.size() < requests) {
+                for (size_t i = 0; i < scan_every && trace.size() < requests; i++) {
+                    size_t id = popularity(rng);
+                    trace.push_back({"/site/" + std::to_string(id), sizes[id]});
+                }
+                for (size_t i = 0; i < scan_length && trace.size() < requests; i++) {
+                    trace.push_back({"/crawl/" + std::to_string(cold_id++), size_dist(rng)});
+                }
+            }
+            return trace;
+        }
+
+        void printResult(const SimulationResult& result) {
+            std::cout << std::left << std::setw(12) << result.policy
+                      << " capacity=" << (result.capacity_bytes / 1024) << "KB"
+                      << " hit_ratio=" << std::fixed << std::setprecision(3) << result.hitRatio()
+                      << " byte_hit_ratio=" << result.byteHitRatio() << std::endl;
+        }
+};
+
+// Compare hit ratio and byte hit ratio of LRU vs W-TinyLFU on a crawler-heavy trace
+TEST_F(CacheBenchmark, ScanResistanceTraceComparison) {
+    auto trace = buildScanTrace(200000, 2000, 5000, 2000);
+    const size_t max_file = 20 * 1024 * 1024;
+
+    for (size_t capacity_mb : {4, 16}) {
+        auto lru = simulateTrace(CachePolicyType::LRU, capacity_mb * 1024 * 1024, max_file, trace);
+        auto tinylfu = simulateTrace(CachePolicyType::WTinyLFU, capacity_mb * 1024 * 1024, max_file, trace);
+        printResult(lru);
+        printResult(tinylfu);
+
+        EXPECT_GT(tinylfu.hitRatio(), lru.hitRatio());
+        EXPECT_GT(tinylfu.byteHitRatio(), lru.byteHitRatio());
+    }
+}
+
+// Bookkeeping bytes per resident entry: the file content is shared and
+// allocated up front, so only the cache's own nodes, links and index count.
+TEST_F(CacheBenchmark, LayoutMemoryPerEntry) {
+    MuteCacheLog mute;
+    const size_t entries = 50000;
+    auto keys = makeKeys(entries);
+    auto file = std::make_shared<const CachedFile>(std::string(100, 'x'), "text/plain");
+
+    size_t before = CountingAllocator::liveBytes();
+    size_t legacy_bytes;
+    {
+        LegacyLRUFileCache legacy(1ULL << 30);
+        for (const auto& key : keys) {
+            legacy.put(key, file);
+        }
+        legacy_bytes = CountingAllocator::liveBytes() - before;
+    }
+
+    before = CountingAllocator::liveBytes();
+    size_t slot_bytes;
+    {
+        LRUFileCache cache(1024, 1, CachePolicyType::LRU);
+        for (const auto& key : keys) {
+            cache.put(key, file);
+        }
+        ASSERT_EQ(cache.getStats().entries, entries);
+        slot_bytes = CountingAllocator::liveBytes() - before;
+    }
+
+    double legacy_per_entry = static_cast<double>(legacy_bytes) / entries;
+    double slot_per_entry = static_cast<double>(slot_bytes) / entries;
+    std::cerr << "shared_ptr node list: " << std::fixed << std::setprecision(1)
+              << legacy_per_entry << " bytes/entry" << std::endl;
+    std::cerr << "slot array + flat index: " << slot_per_entry << " bytes/entry" << std::endl;
+
+    EXPECT_LT(slot_per_entry, legacy_per_entry);
+}
+
+// Mixed get/put throughput on Zipf traffic with a cache holding ~1/4 of the keys
+TEST_F(CacheBenchmark, LayoutOpsPerSecond) {
+    MuteCacheLog mute;
+    const size_t objects = 20000;
+    const size_t file_bytes = 1024;
+    auto keys = makeKeys(objects);
+    auto ids = makeZipfIds(1000000, objects);
+    auto file = std::make_shared<const CachedFile>(std::string(file_bytes, 'x'), "text/plain");
+    const size_t capacity_mb = objects * file_bytes / 4 / (1024 * 1024);
+
+    LegacyLRUFileCache legacy(capacity_mb * 1024 * 1024);
+    LRUFileCache lru(capacity_mb, 1, CachePolicyType::LRU);
+    LRUFileCache tinylfu(capacity_mb, 1, CachePolicyType::WTinyLFU);
+
+    double legacy_ops = opsPerSecond(legacy, keys, ids, file);
+    double lru_ops = opsPerSecond(lru, keys, ids, file);
+    double tinylfu_ops = opsPerSecond(tinylfu, keys, ids, file);
+
+    std::cerr << std::fixed << std::setprecision(0)
+              << "shared_ptr node list (LRU): " << legacy_ops << " ops/s" << std::endl
+              << "slot array (LRU):           " << lru_ops << " ops/s" << std::endl
+              << "slot array (W-TinyLFU):     " << tinylfu_ops << " ops/s" << std::endl;
+
+    EXPECT_GT(lru.getStats().hits, 0u);
+    EXPECT_GT(tinylfu.getStats().hits, 0u);
+    // Same policy, same traffic, no logging on either side: the slot array
+    // must not lose to the layout it replaced
+    EXPECT_GT(lru_ops, legacy_ops);
+}
+
+// 64 readers hammering a fully cached working set (99% gets, 1% replacements),
+// locked backend vs lock-free RCU reads
+TEST_F(CacheBenchmark, ConcurrentReadHeavyBackends) {
+    MuteCacheLog mute;
+    const size_t objects = 4096;
+    const size_t threads = 64;
+    const size_t ops_per_thread = 20000;
+    auto keys = makeKeys(objects);
+    auto ids = makeZipfIds(ops_per_thread, objects);
+    auto file = std::make_shared<const CachedFile>(std::string(1024, 'x'), "text/plain");
+
+    auto run = [&](LRUFileCache& cache) {
+        for (const auto& key : keys) {
+            cache.put(key, file);
+        }
+        std::atomic<bool> go{false};
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; t++) {
+            workers.emplace_back([&, t] {
+                while (!go.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                }
+                for (size_t i = 0; i < ops_per_thread; i++) {
+                    const std::string& key = keys[ids[(i + t * 97) % ids.size()]];
+                    if (i % 100 == 99) {
+                        cache.put(key, file);
+                    } else if (!cache.get(key)) {
+                        cache.put(key, file);
+                    }
+                }
+            });
+        }
+        auto start = std::chrono::steady_clock::now();
+        go.store(true, std::memory_order_release);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return threads * ops_per_thread / seconds;
+    };
+
+    LRUFileCache locked(16, 1, CachePolicyType::LRU, CacheBackend::Locked);
+    LRUFileCache rcu(16, 1, CachePolicyType::LRU, CacheBackend::RCU);
+    double locked_ops = run(locked);
+    double rcu_ops = run(rcu);
+
+    std::cerr << std::fixed << std::setprecision(2)
+              << threads << " threads, locked: " << locked_ops / 1e6 << " Mops/s" << std::endl
+              << threads << " threads, RCU:    " << rcu_ops / 1e6 << " Mops/s" << std::endl;
+
+    EXPECT_GT(locked.getStats().hits, 0u);
+    EXPECT_GT(rcu.getStats().hits, 0u);
+    EXPECT_EQ(rcu.getStats().entries, objects);
+}
+
+// Stats polling must not slow the request path: the same read-heavy workload
+// with and without a thread calling getStats() in a tight loop
+TEST_F(CacheBenchmark, StatsPollingUnderLoad) {
+    MuteCacheLog mute;
+    const size_t objects = 1024;
+    const size_t threads = 16;
+    const size_t ops_per_thread = 50000;
+    auto keys = makeKeys(objects);
+    auto ids = makeZipfIds(ops_per_thread, objects);
+    auto file = std::make_shared<const CachedFile>(std::string(1024, 'x'), "text/plain");
+
+    LRUFileCache cache(16, 1, CachePolicyType::LRU, CacheBackend::RCU);
+    for (const auto& key : keys) {
+        cache.put(key, file);
+    }
+
+    auto run = [&](bool poll) {
+        std::atomic<bool> done{false};
+        size_t polls = 0;
+        std::thread poller;
+        if (poll) {
+            poller = std::thread([&] {
+                while (!done.load(std::memory_order_relaxed)) {
+                    polls += cache.getStats().hits > 0;
+                }
+            });
+        }
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; t++) {
+            workers.emplace_back([&, t] {
+                for (size_t i = 0; i < ops_per_thread; i++) {
+                    cache.get(keys[ids[(i + t * 97) % ids.size()]]);
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        done = true;
+        if (poller.joinable()) {
+            poller.join();
+        }
+        return std::make_pair(threads * ops_per_thread / seconds, polls);
+    };
+
+    auto quiet = run(false);
+    auto polled = run(true);
+    std::cerr << std::fixed << std::setprecision(2)
+              << "no stats polling: " << quiet.first / 1e6 << " Mops/s" << std::endl
+              << "polling getStats: " << polled.first / 1e6 << " Mops/s ("
+              << polled.second << " polls)" << std::endl;
+
+    EXPECT_EQ(cache.getStats().hits, 2 * threads * ops_per_thread);
+}
+
+// Access log parsing for the cache_simulator tool
+TEST_F(CacheBenchmark, TraceParsing) {
+    std::istringstream log(
+        "/index.html 5120\n"
+        "# comment\n"
+        "127.0.0.1 - - [10/Oct/2025:13:55:36 +0000] \"GET /css/site.css?v=3 HTTP/1.1\" 200 2326 \"-\" \"curl\"\n"
+        "127.0.0.1 - - [10/Oct/2025:13:55:37 +0000] \"GET /missing HTTP/1.1\" 404 153\n"
+        "127.0.0.1 - - [10/Oct/2025:13:55:38 +0000] \"POST /form HTTP/1.1\" 200 10\n"
+        "127.0.0.1 - - [10/Oct/2025:13:55:39 +0000] \"GET /empty HTTP/1.1\" 200 -\n");
+    size_t skipped = 0;
+    auto trace = loadTrace(log, &skipped);
+
+    ASSERT_EQ(trace.size(), 2u);
+    EXPECT_EQ(trace[0].key, "/index.html");
+    EXPECT_EQ(trace[0].size_bytes, 5120u);
+    EXPECT_EQ(trace[1].key, "/css/site.css");
+    EXPECT_EQ(trace[1].size_bytes, 2326u);
+    EXPECT_EQ(skipped, 4u);
+
+    // Charging cache memory instead of payload can only lower the hit ratio
+    auto payload = simulateTrace(CachePolicyType::LRU, 8 * 1024, 1024 * 1024, trace);
+    auto memory = simulateTrace(CachePolicyType::LRU, 8 * 1024, 1024 * 1024, trace,
+        [](const TraceRecord& record) { return LRUFileCache::estimateCharge(record.key.size(), record.size_bytes); });
+    EXPECT_EQ(payload.requests, 2u);
+    EXPECT_LE(memory.hits, payload.hits);
+}
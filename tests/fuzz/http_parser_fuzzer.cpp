@@ -0,0 +1,116 @@
+// Fuzz target for the request parsers and body framing.
+//
+// With clang and libFuzzer (cmake -DENABLE_FUZZING=ON); new inputs are
+// written to the first directory, so the seed corpus goes second:
+//   ./http_parser_fuzzer -dict=../tests/fuzz/http.dict fuzz-corpus ../tests/corpus/http
+// Built with HTTP_FUZZ_STANDALONE instead, main() replays the files and
+// directories it is given (http_fuzz_replay, run by ctest over the corpus);
+// with --print it writes the outcome of every message in http.expected form.
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include "http/HttpParser.h"
+#include "HttpCorpus.h"
+
+namespace {
+
+void check(bool condition, const char* what)
+{
+    if (!condition) {
+        std::fprintf(stderr, "http_parser_fuzzer: invariant failed: %s\n", what);
+        std::abort();
+    }
+}
+
+bool within(std::string_view part, std::string_view whole)
+{
+    return part.empty() || (part.data() >= whole.data() && part.data() + part.size() <= whole.data() + whole.size());
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    std::string_view wire(reinterpret_cast<const char*>(data), size);
+    HttpRequestView view;
+    HttpRequestParser parser;
+    HttpBodyDecoder decoder;
+
+    // Incremental parsing must not depend on how the bytes were split up
+    std::vector<ParsedMessage> whole = parseMessages(wire, 0, view, parser, decoder);
+    size_t piece = size ? 1 + data[0] % 17 : 1;
+    check(parseMessages(wire, piece, view, parser, decoder) == whole, "split reads change the result");
+
+    size_t previous_end = 0;
+    for (const ParsedMessage& message : whole) {
+        if (message.status != ParsedMessage::kComplete) {
+            check(message.status == ParsedMessage::kIncomplete || message.status == 400 || message.status == 414 ||
+                  message.status == 431 || message.status == 501, "unexpected error status");
+            continue;
+        }
+        check(message.consumed > previous_end && message.consumed <= size, "message bounds");
+        check(within(message.method, wire) && within(message.target, wire), "views outside the input");
+        check(!message.method.empty() && message.headers <= HttpRequestView::kMaxHeaders, "request shape");
+        check(message.body_bytes < message.consumed - previous_end, "body larger than the message");
+        previous_end = message.consumed;
+    }
+
+    // The one-shot parser and its owning fallback agree with each other
+    HttpRequestView one_shot;
+    if (HttpParser::parse(wire, one_shot)) {
+        check(within(one_shot.method, wire) && within(one_shot.path, wire) && within(one_shot.body, wire),
+              "one-shot views outside the input");
+        HttpRequest owning = HttpParser::parse(std::string(wire));
+        check(owning.getMethod() == one_shot.method && owning.getPath() == one_shot.path &&
+              owning.getHeaders().size() == one_shot.header_count, "owning parse differs");
+        for (size_t i = 0; i < one_shot.header_count; i++) {
+            check(owning.getHeader(one_shot.headers[i].name) == one_shot.getHeader(one_shot.headers[i].name),
+                  "header lookup differs");
+        }
+    }
+    return 0;
+}
+
+#ifdef HTTP_FUZZ_STANDALONE
+#include <filesystem>
+#include <iostream>
+
+int main(int argc, char* argv[])
+{
+    bool print = false;
+    size_t inputs = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        if (argument == "--print") {
+            print = true;
+            continue;
+        }
+        std::vector<CorpusRequest> corpus;
+        if (std::filesystem::is_directory(argument)) {
+            corpus = loadCorpus(argument);
+        } else {
+            std::ifstream in(argument, std::ios::binary);
+            std::ostringstream wire;
+            wire << in.rdbuf();
+            corpus.push_back({std::filesystem::path(argument).filename().string(), wire.str()});
+        }
+        for (const CorpusRequest& request : corpus) {
+            LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t*>(request.wire.data()), request.wire.size());
+            inputs++;
+            if (print) {
+                HttpRequestView view;
+                HttpRequestParser parser;
+                HttpBodyDecoder decoder;
+                auto messages = parseMessages(request.wire, 0, view, parser, decoder);
+                for (size_t m = 0; m < messages.size(); m++) {
+                    std::cout << request.name << "#" << m << " " << messages[m].summary() << "\n";
+                }
+            }
+        }
+    }
+    std::cerr << "Replayed " << inputs << " inputs" << std::endl;
+    return inputs > 0 ? 0 : 1;
+}
+#endif
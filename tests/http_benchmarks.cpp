@@ -0,0 +1,478 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory_resource>
+#include <new>
+#include <sstream>
+#include <vector>
+#include "http/HttpParser.h"
+#include "http/HttpScanner.h"
+#include "http/ResponseBuilder.h"
+#include "handlers/StaticResponses.h"
+#include "handlers/ResponseGenerator.h"
+#include "HttpCorpus.h"
+#include "CountingAllocator.h"
+
+// The parser before string_view slicing: getline into a vector of lines, an
+// istringstream for the request line and substr/trim copies for every header.
+// Kept here only as the baseline, without its per-header logging.
+static HttpRequest legacyParse(const std::string& raw_request)
+{
+    HttpRequest request;
+    std::vector<std::string> lines;
+    std::istringstream stream(raw_request);
+    std::string line;
+    while (std::getline(stream, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        lines.push_back(line);
+    }
+    if (lines.empty()) {
+        return request;
+    }
+
+    auto trim = [](const std::string& str) {
+        size_t start = str.find_first_not_of(" \t\r\n");
+        if (start == std::string::npos) {
+            return std::string();
+        }
+        size_t end = str.find_last_not_of(" \t\r\n");
+        return str.substr(start, end - start + 1);
+    };
+
+    std::istringstream iss(lines[0]);
+    std::string method, path, version;
+    if (!(iss >> method >> path >> version)) {
+        return request;
+    }
+    request.setMethod(method);
+    request.setPath(path);
+    request.setVersion(version);
+
+    size_t i = 1;
+    while (i < lines.size() && !lines[i].empty()) {
+        size_t colon_pos = lines[i].find(':');
+        if (colon_pos != std::string::npos) {
+            request.setHeader(trim(lines[i].substr(0, colon_pos)), trim(lines[i].substr(colon_pos + 1)));
+        }
+        i++;
+    }
+    return request;
+}
+
+class HttpBenchmark : public ::testing::Test {
+    protected:
+        struct Measurement {
+            double ns_per_request;
+            double allocations_per_request;
+        };
+
+        // What a desktop Chrome sends for a page load
+        static std::string browserRequest() {
+            return "GET /assets/css/main.css?v=3 HTTP/1.1\r\n"
+                   "Host: www.example.com\r\n"
+                   "Connection: keep-alive\r\n"
+                   "sec-ch-ua: \"Chromium\";v=\"124\", \"Google Chrome\";v=\"124\", \"Not-A.Brand\";v=\"99\"\r\n"
+                   "sec-ch-ua-mobile: ?0\r\n"
+                   "User-Agent: Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 "
+                   "(KHTML, like Gecko) Chrome/124.0.0.0 Safari/537.36\r\n"
+                   "sec-ch-ua-platform: \"Windows\"\r\n"
+                   "Accept: text/css,*/*;q=0.1\r\n"
+                   "Sec-Fetch-Site: same-origin\r\n"
+                   "Sec-Fetch-Mode: no-cors\r\n"
+                   "Sec-Fetch-Dest: style\r\n"
+                   "Referer: https://www.example.com/\r\n"
+                   "Accept-Encoding: gzip, deflate, br, zstd\r\n"
+                   "Accept-Language: en-US,en;q=0.9,de;q=0.8\r\n"
+                   "Cookie: _ga=GA1.1.1234567890.1700000000; session=9f86d081884c7d659a2feaa0c55ad015; "
+                   "theme=dark\r\n"
+                   "If-None-Match: \"5d41402abc4b2a76\"\r\n"
+                   "If-Modified-Since: Tue, 14 May 2024 08:12:31 GMT\r\n"
+                   "\r\n";
+        }
+
+        // What curl sends
+        static std::string shortRequest() {
+            return "GET /index.html HTTP/1.1\r\n"
+                   "Host: localhost:8080\r\n"
+                   "User-Agent: curl/8.5.0\r\n"
+                   "Accept: */*\r\n"
+                   "\r\n";
+        }
+
+        // A browser request carrying ~4KB of analytics and consent cookies
+        static std::string cookieHeavyRequest() {
+            std::string cookies;
+            for (int i = 0; cookies.size() < 4096; i++) {
+                cookies += "_tracker_" + std::to_string(i) + "=GA1.2." + std::to_string(1000000007ULL * (i + 1)) +
+                           ".1700000000-AbCdEfGhIjKlMnOpQrStUvWxYz0123456789; ";
+            }
+            std::string raw = browserRequest();
+            raw.insert(raw.size() - 2, "Cookie: " + cookies + "consent=granted\r\n");
+            return raw;
+        }
+
+        template<class Parse>
+        static Measurement measure(size_t iterations, Parse&& parse) {
+            size_t allocations_before = CountingAllocator::totalAllocations();
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < iterations; i++) {
+                parse();
+            }
+            double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            size_t allocations = CountingAllocator::totalAllocations() - allocations_before;
+            return {ns / iterations, static_cast<double>(allocations) / iterations};
+        }
+
+        static void print(const char* name, const Measurement& result) {
+            std::cerr << std::left << std::setw(28) << name << std::right << std::fixed
+                      << std::setprecision(0) << std::setw(8) << result.ns_per_request << " ns/request "
+                      << std::setprecision(1) << std::setw(6) << result.allocations_per_request
+                      << " allocations/request" << std::endl;
+        }
+};
+
+// Old istringstream parser vs the zero-copy view parser (and its owning
+// fallback) on realistic browser headers
+TEST_F(HttpBenchmark, ParserBrowserHeaders) {
+    const size_t iterations = 50000;
+    const std::string raw = browserRequest();
+    size_t checksum = 0;
+
+    auto legacy = measure(iterations, [&] {
+        checksum += legacyParse(raw).getHeaders().size();
+    });
+    auto owning = measure(iterations, [&] {
+        checksum += HttpParser::parse(raw).getHeaders().size();
+    });
+    HttpRequestView view;
+    auto zero_copy = measure(iterations, [&] {
+        HttpParser::parse(std::string_view(raw), view);
+        checksum += view.header_count;
+    });
+
+    print("istringstream (legacy):", legacy);
+    print("view -> owning HttpRequest:", owning);
+    print("string_view (zero-copy):", zero_copy);
+
+    EXPECT_EQ(checksum, 3 * iterations * 16);
+    EXPECT_EQ(zero_copy.allocations_per_request, 0.0);
+    EXPECT_LT(zero_copy.ns_per_request, legacy.ns_per_request);
+    EXPECT_LT(owning.allocations_per_request, legacy.allocations_per_request);
+}
+
+// Scalar byte-at-a-time scanning vs the SSE4.2 and AVX2 kernels, on a short
+// request and on one dominated by a long Cookie header
+TEST_F(HttpBenchmark, ScannerKernels) {
+    using Kernel = HttpScanner::Kernel;
+    Kernel original = HttpScanner::activeKernel();
+    std::cerr << "Dispatch picks: " << HttpScanner::kernelName(original) << std::endl;
+
+    for (const std::string& raw : {shortRequest(), cookieHeavyRequest()}) {
+        std::cerr << raw.size() << " byte request:" << std::endl;
+        HttpRequestView view;
+        double scalar_ns = 0;
+        for (Kernel kernel : {Kernel::Scalar, Kernel::SSE42, Kernel::AVX2}) {
+            if (!HttpScanner::setKernel(kernel)) {
+                continue;
+            }
+            size_t parsed = 0;
+            auto result = measure(100000, [&] {
+                parsed += HttpParser::parse(std::string_view(raw), view);
+            });
+            print(HttpScanner::kernelName(kernel), result);
+            EXPECT_EQ(parsed, 100000u);
+            EXPECT_EQ(result.allocations_per_request, 0.0);
+            if (kernel == Kernel::Scalar) {
+                scalar_ns = result.ns_per_request;
+            } else if (raw.size() > 4096) {
+                // The vector kernels only pay off on long fields
+                EXPECT_LT(result.ns_per_request, scalar_ns);
+            }
+        }
+    }
+    HttpScanner::setKernel(original);
+}
+
+// Validation, keep-alive and method routing as they were: string compares
+// against the method and version on every call
+static int legacyValidateAndRoute(const HttpRequestView& request)
+{
+    std::string_view method = request.method;
+    if (method.empty() || request.path.empty() || request.path[0] != '/' ||
+        !(method == "GET" || method == "POST" || method == "PUT" ||
+          method == "DELETE" || method == "HEAD" || method == "OPTIONS")) {
+        return 400;
+    }
+    int keep_alive = request.version == "HTTP/1.1" ? 1 : 0;
+    if (method == "GET" || method == "HEAD") {
+        return 200 + keep_alive;
+    }
+    if (method == "PUT" || method == "POST") {
+        return 201 + keep_alive;
+    }
+    return 405 + keep_alive;
+}
+
+// The same decisions on the enums the parser resolved
+static int enumValidateAndRoute(const HttpRequestView& request)
+{
+    if (!request.isValid()) {
+        return 400;
+    }
+    int keep_alive = request.isHttp11() ? 1 : 0;
+    switch (request.method_id) {
+        case HttpMethod::Get:
+        case HttpMethod::Head:
+            return 200 + keep_alive;
+        case HttpMethod::Put:
+        case HttpMethod::Post:
+            return 201 + keep_alive;
+        default:
+            return 405 + keep_alive;
+    }
+}
+
+// Per-request cost of validating a request and picking its route: string
+// compares on each check vs enums resolved once by the parser (shown with
+// and without that one-time lookup)
+TEST_F(HttpBenchmark, ValidateAndRoute) {
+    const std::vector<std::string> raw = {
+        "GET /index.html HTTP/1.1\r\n\r\n", "HEAD /css/style.css HTTP/1.1\r\n\r\n",
+        "POST /upload/a HTTP/1.1\r\n\r\n", "PUT /upload/b HTTP/1.0\r\n\r\n",
+        "DELETE /item HTTP/1.1\r\n\r\n", "OPTIONS /about HTTP/1.1\r\n\r\n",
+        "GET /about HTTP/1.0\r\n\r\n", "PATCH /item HTTP/1.1\r\n\r\n"};
+    std::vector<HttpRequestView> views(raw.size());
+    for (size_t i = 0; i < raw.size(); i++) {
+        ASSERT_TRUE(HttpParser::parse(std::string_view(raw[i]), views[i]));
+        ASSERT_EQ(legacyValidateAndRoute(views[i]), enumValidateAndRoute(views[i])) << raw[i];
+    }
+
+    const size_t rounds = 200000;
+    size_t legacy_sum = 0, enum_sum = 0, lookup_sum = 0;
+    auto legacy = measure(rounds, [&] {
+        for (const HttpRequestView& view : views) {
+            legacy_sum += legacyValidateAndRoute(view);
+        }
+    });
+    auto resolved = measure(rounds, [&] {
+        for (const HttpRequestView& view : views) {
+            enum_sum += enumValidateAndRoute(view);
+        }
+    });
+    auto with_lookup = measure(rounds, [&] {
+        for (HttpRequestView& view : views) {
+            view.method_id = HttpMethodNames::lookup(view.method);
+            view.version_id = HttpMethodNames::lookupVersion(view.version);
+            lookup_sum += enumValidateAndRoute(view);
+        }
+    });
+
+    auto perRequest = [&](const Measurement& result) {
+        return Measurement{result.ns_per_request / views.size(), result.allocations_per_request / views.size()};
+    };
+    print("string compares:", perRequest(legacy));
+    print("enums:", perRequest(resolved));
+    print("enum lookup + enums:", perRequest(with_lookup));
+
+    EXPECT_EQ(enum_sum, legacy_sum);
+    EXPECT_EQ(lookup_sum, legacy_sum);
+    EXPECT_LT(resolved.ns_per_request, legacy.ns_per_request);
+    EXPECT_LT(with_lookup.ns_per_request, legacy.ns_per_request);
+}
+
+// The head of a cached-file response: appended with += and std::to_string
+// as FileHandler used to (without a Date, and with one from strftime per
+// response) vs the builder with the cached Date, into a fresh string and
+// into a reused arena buffer
+TEST_F(HttpBenchmark, ResponseHeadBuilding) {
+    const std::string mime_type = "text/css";
+    const std::string etag = "\"5d41402abc4b2a76\"";
+    const size_t content_length = 48213;
+
+    auto legacyHead = [&](bool with_date) {
+        std::string response;
+        response += "HTTP/1.1 " + std::to_string(200) + " " + "OK" + "\r\n";
+        response += "Content-Type: " + mime_type + "\r\n";
+        response += "Content-Length: " + std::to_string(content_length) + "\r\n";
+        if (with_date) {
+            char date[64];
+            std::time_t now = std::time(nullptr);
+            std::tm utc{};
+            gmtime_r(&now, &utc);
+            std::strftime(date, sizeof(date), "%a, %d %b %Y %H:%M:%S GMT", &utc);
+            response += "Date: " + std::string(date) + "\r\n";
+        }
+        response += "Server: CustomHTTPServer/1.0\r\n";
+        response += "ETag: " + etag + "\r\n";
+        response += "Cache-Control: max-age=3600\r\n";
+        response += "Connection: close\r\n";
+        response += "\r\n";
+        return response;
+    };
+    auto buildHead = [&](auto& response) {
+        BasicResponseBuilder<std::decay_t<decltype(response)>>(response)
+            .status(200, "OK")
+            .header("Content-Type", mime_type)
+            .header("Content-Length", static_cast<uint64_t>(content_length))
+            .header("ETag", etag)
+            .header("Cache-Control", "max-age=3600")
+            .standardHeaders()
+            .endHeaders();
+    };
+
+    std::string built;
+    buildHead(built);
+    EXPECT_EQ(built.size(), legacyHead(true).size());
+    EXPECT_NE(built.find("\r\nDate: " + std::string(HttpDate::now()) + "\r\n"), std::string::npos);
+
+    const size_t iterations = 200000;
+    size_t checksum = 0;
+    auto legacy = measure(iterations, [&] { checksum += legacyHead(false).size(); });
+    auto legacy_date = measure(iterations, [&] { checksum += legacyHead(true).size(); });
+    auto builder = measure(iterations, [&] {
+        std::string response;
+        buildHead(response);
+        checksum += response.size();
+    });
+    char arena_buffer[1024];
+    auto arena = measure(iterations, [&] {
+        std::pmr::monotonic_buffer_resource resource(arena_buffer, sizeof(arena_buffer), std::pmr::null_memory_resource());
+        std::pmr::string response(&resource);
+        buildHead(response);
+        checksum += response.size();
+    });
+
+    print("+= / to_string, no Date:", legacy);
+    print("+= / to_string + strftime:", legacy_date);
+    print("builder, cached Date:", builder);
+    print("builder into arena:", arena);
+
+    EXPECT_GT(checksum, 0u);
+    EXPECT_LE(builder.allocations_per_request, 1.0);
+    EXPECT_EQ(arena.allocations_per_request, 0.0);
+    EXPECT_LT(builder.ns_per_request, legacy_date.ns_per_request);
+}
+
+// /about, /status and the 404 page: wrapped in headers (and the 404 HTML
+// rebuilt) on every call, as ResponseGenerator does, vs prebuilt bodies
+// that are shared behind a head built in the request arena
+TEST_F(HttpBenchmark, StaticPageResponses) {
+    StaticResponses prebuilt;
+    HttpRequestView plain, gzip;
+    ASSERT_TRUE(HttpParser::parse(std::string_view("GET /about HTTP/1.1\r\n\r\n"), plain));
+    ASSERT_TRUE(HttpParser::parse(std::string_view("GET /about HTTP/1.1\r\nAccept-Encoding: gzip, br\r\n\r\n"),
+                                  gzip));
+
+    const size_t iterations = 20000;
+    size_t bytes = 0, identity_bytes = 0, gzip_bytes = 0;
+    auto per_call = measure(iterations, [&] {
+        bytes += HttpResponse(ResponseGenerator::createAboutPageResponse()).size();
+        bytes += HttpResponse(ResponseGenerator::createStatusPageResponse()).size();
+        bytes += HttpResponse(ResponseGenerator::create404Response()).size();
+    });
+    char arena_buffer[2048];
+    auto shared = [&](const HttpRequestView& request, size_t& total) {
+        return measure(iterations, [&] {
+            std::pmr::monotonic_buffer_resource arena(arena_buffer, sizeof(arena_buffer), std::pmr::null_memory_resource());
+            total += prebuilt.serve(StaticResponses::Page::About, request, &arena).size();
+            total += prebuilt.serve(StaticResponses::Page::Status, request, &arena).size();
+            total += prebuilt.serve(StaticResponses::Page::NotFound, request, &arena).size();
+        });
+    };
+    auto identity = shared(plain, identity_bytes);
+    auto compressed = shared(gzip, gzip_bytes);
+
+    auto perPage = [](const Measurement& result) {
+        return Measurement{result.ns_per_request / 3, result.allocations_per_request / 3};
+    };
+    std::cerr << "bytes per page set: " << bytes / iterations << " generated, " << identity_bytes / iterations
+              << " prebuilt, " << gzip_bytes / iterations << " prebuilt gzip" << std::endl;
+    print("built per call:", perPage(per_call));
+    print("prebuilt, shared body:", perPage(identity));
+    print("prebuilt gzip:", perPage(compressed));
+
+    EXPECT_LT(gzip_bytes, identity_bytes / 2);
+    EXPECT_EQ(identity.allocations_per_request, 0.0);
+    EXPECT_EQ(compressed.allocations_per_request, 0.0);
+    EXPECT_GT(per_call.allocations_per_request, 0.0);
+}
+
+// The real-world corpus: every message must parse exactly as recorded in
+// tests/corpus/http.expected, however it is split across reads, and the
+// zero-copy path must stay allocation-free and ahead of the legacy parser
+TEST_F(HttpBenchmark, CorpusThroughput) {
+    const std::vector<CorpusRequest> corpus = loadCorpus(HTTP_CORPUS_DIR "/http");
+    ASSERT_FALSE(corpus.empty());
+
+    std::map<std::string, std::string> expected;
+    std::ifstream expectations(HTTP_CORPUS_DIR "/http.expected");
+    for (std::string line; std::getline(expectations, line);) {
+        if (!line.empty() && line[0] != '#') {
+            size_t space = line.find(' ');
+            expected[line.substr(0, space)] = line.substr(space + 1);
+        }
+    }
+
+    HttpRequestView view;
+    HttpRequestParser parser;
+    HttpBodyDecoder decoder;
+    size_t messages = 0;
+    size_t bytes = 0;
+    for (const CorpusRequest& request : corpus) {
+        std::vector<ParsedMessage> whole = parseMessages(request.wire, 0, view, parser, decoder);
+        for (size_t piece : {1, 7, 512}) {
+            EXPECT_TRUE(parseMessages(request.wire, piece, view, parser, decoder) == whole)
+                << request.name << " split into " << piece << " byte reads";
+        }
+        for (size_t i = 0; i < whole.size(); i++) {
+            std::string key = request.name + "#" + std::to_string(i);
+            auto it = expected.find(key);
+            ASSERT_NE(it, expected.end()) << key << " is not in http.expected";
+            EXPECT_EQ(whole[i].summary(), it->second) << key;
+            expected.erase(it);
+        }
+        messages += whole.size();
+        bytes += request.wire.size();
+    }
+    for (const auto& missing : expected) {
+        ADD_FAILURE() << missing.first << " is expected but was not parsed";
+    }
+
+    const size_t passes = 2000;
+    size_t checksum = 0;
+    auto legacy = measure(passes, [&] {
+        for (const CorpusRequest& request : corpus) {
+            checksum += legacyParse(request.wire).getHeaders().size();
+        }
+    });
+    auto zero_copy = measure(passes, [&] {
+        for (const CorpusRequest& request : corpus) {
+            std::string_view wire = request.wire;
+            while (!wire.empty()) {
+                ParsedMessage message = parseMessage(wire, 0, view, parser, decoder);
+                checksum += message.headers;
+                if (message.status != ParsedMessage::kComplete) {
+                    break;
+                }
+                wire.remove_prefix(message.consumed);
+            }
+        }
+    });
+
+    double seconds_per_pass = zero_copy.ns_per_request / 1e9;
+    std::cerr << corpus.size() << " files, " << messages << " messages, " << bytes << " bytes; zero-copy parses "
+              << std::fixed << std::setprecision(1) << bytes / seconds_per_pass / (1024 * 1024) << " MB/s" << std::endl;
+    print("istringstream (legacy):", {legacy.ns_per_request / corpus.size(), legacy.allocations_per_request / corpus.size()});
+    print("zero-copy head + framing:", {zero_copy.ns_per_request / messages, zero_copy.allocations_per_request / messages});
+
+    EXPECT_GT(checksum, 0u);
+    EXPECT_EQ(zero_copy.allocations_per_request, 0.0);
+    EXPECT_LT(zero_copy.ns_per_request, legacy.ns_per_request);
+}
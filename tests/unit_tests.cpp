@@ -1,7 +1,53 @@
 #include <gtest/gtest.h>
 #include <chrono>
 #include <thread>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <fcntl.h>
+#include <zlib.h>
 #include "core/Server.h"
+#include "http/HttpScanner.h"
+#include "http/HttpRequestParser.h"
+#include "http/HttpBodyDecoder.h"
+#include "http/HttpDate.h"
+#include "http/ResponseBuilder.h"
+#include "cache/CacheSnapshot.h"
+#include "cache/L1FileCache.h"
+#include "connection/RequestArena.h"
+#include "CountingAllocator.h"
+
+// Reaches into Server so tests can run its connection loop without a listener
+class ServerTestAccess {
+public:
+    static FileHandler& fileHandler(Server& server) { return server.file_handler; }
+
+    // Runs handleConnection on this thread for a client that sends `wire`
+    // and then closes its side; returns everything the server wrote back.
+    // `allocations` receives the heap allocations handleConnection made.
+    static std::string exchange(Server& server, const std::string& wire, size_t* allocations = nullptr) {
+        int fds[2];
+        EXPECT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+        std::string received;
+        std::thread client([&] {
+            EXPECT_EQ(write(fds[1], wire.data(), wire.size()), static_cast<ssize_t>(wire.size()));
+            shutdown(fds[1], SHUT_WR);
+            char buffer[16 * 1024];
+            for (ssize_t n; (n = read(fds[1], buffer, sizeof(buffer))) > 0;) {
+                received.append(buffer, n);
+            }
+            close(fds[1]);
+        });
+        auto connection = std::make_unique<Connection>(fds[0], "127.0.0.1");
+        size_t before = CountingAllocator::threadAllocations();
+        server.handleConnection(std::move(connection));
+        if (allocations) {
+            *allocations = CountingAllocator::threadAllocations() - before;
+        }
+        client.join();
+        return received;
+    }
+};
 
 class ConnectionTest : public ::testing::Test {
     protected:
@@ -63,4 +109,1168 @@ TEST_F(ConnectionTest, HttpRequestValidation)
     HttpRequest invalid;
     invalid.setPath("/test");  // No method
     EXPECT_FALSE(invalid.isValid());
-}
\ No newline at end of file
+}
+
+// Test that the parser slices the request in place and keeps the old semantics
+TEST(HttpParserTest, ParsesViewsIntoTheBuffer)
+{
+    std::string raw = "GET /index.html HTTP/1.1\r\n"
+                      "Host: localhost:8080\r\n"
+                      "connection:  Keep-Alive \r\n"
+                      "Accept: text/html,*/*;q=0.8\r\n"
+                      "\r\n"
+                      "payload";
+
+    HttpRequestView view;
+    ASSERT_TRUE(HttpParser::parse(std::string_view(raw), view));
+    EXPECT_TRUE(view.isValid());
+    EXPECT_EQ(view.method, "GET");
+    EXPECT_EQ(view.path, "/index.html");
+    EXPECT_EQ(view.version, "HTTP/1.1");
+    EXPECT_EQ(view.header_count, 3u);
+    EXPECT_EQ(view.getHeader("HOST"), "localhost:8080");
+    EXPECT_EQ(view.getHeader("Accept"), "text/html,*/*;q=0.8");
+    EXPECT_TRUE(view.wantsKeepAlive());
+    EXPECT_EQ(view.body, "payload");
+
+    // Every field points into the original buffer
+    EXPECT_GE(view.path.data(), raw.data());
+    EXPECT_LE(view.body.data() + view.body.size(), raw.data() + raw.size());
+
+    // Bare LF line endings and an unterminated header block are accepted
+    ASSERT_TRUE(HttpParser::parse(std::string_view("GET / HTTP/1.0\nConnection: close"), view));
+    EXPECT_EQ(view.getHeader("Connection"), "close");
+    EXPECT_FALSE(view.wantsKeepAlive());
+
+    EXPECT_FALSE(HttpParser::parse(std::string_view("GET /\r\n\r\n"), view));
+    EXPECT_FALSE(HttpParser::parse(std::string_view("GET / HTTP/1.1 extra\r\n\r\n"), view));
+
+    // The owning fallback carries the same request
+    HttpRequest request = HttpParser::parse(raw);
+    EXPECT_TRUE(request.isValid());
+    EXPECT_EQ(request.getPath(), "/index.html");
+    EXPECT_EQ(request.getHeader("Host"), "localhost:8080");
+    EXPECT_EQ(request.getBody(), "payload");
+}
+
+// Test that every SIMD kernel the CPU has agrees with the scalar scan, at
+// every stop position and across the 16/32 byte block boundaries
+TEST(HttpParserTest, ScannerKernelsMatchScalar)
+{
+    using Kernel = HttpScanner::Kernel;
+    Kernel original = HttpScanner::activeKernel();
+
+    std::string text(100, 'a');
+    std::vector<std::vector<size_t>> results;
+    for (Kernel kernel : {Kernel::Scalar, Kernel::SSE42, Kernel::AVX2}) {
+        if (!HttpScanner::setKernel(kernel)) {
+            continue;
+        }
+        std::vector<size_t> lengths;
+        for (int byte = 0; byte < 256; byte++) {
+            for (size_t position : {0, 5, 15, 16, 31, 32, 33, 70, 99}) {
+                text.assign(100, 'a');
+                text[position] = static_cast<char>(byte);
+                for (size_t size : {text.size(), position}) {
+                    lengths.push_back(HttpScanner::tokenLength(text.data(), size));
+                    lengths.push_back(HttpScanner::targetLength(text.data(), size));
+                    lengths.push_back(HttpScanner::fieldValueLength(text.data(), size));
+                }
+            }
+        }
+        results.push_back(lengths);
+    }
+    HttpScanner::setKernel(original);
+
+    for (size_t i = 1; i < results.size(); i++) {
+        EXPECT_EQ(results[i], results[0]);
+    }
+
+    std::string_view separators = "\"(),/:;<=>?@[\\]{} \t";
+    for (char c : separators) {
+        EXPECT_FALSE(HttpScanner::isTokenChar(c)) << c;
+    }
+    for (char c : std::string_view("!#$%&'*+-.^_`|~09azAZ")) {
+        EXPECT_TRUE(HttpScanner::isTokenChar(c)) << c;
+    }
+}
+
+// Test that malformed header lines are rejected instead of skipped
+TEST(HttpParserTest, RejectsInvalidHeaderLines)
+{
+    HttpRequestView view;
+    EXPECT_TRUE(HttpParser::parse(std::string_view("GET / HTTP/1.1\r\nX-Ok: a\tb \r\n\r\n"), view));
+    EXPECT_EQ(view.getHeader("X-Ok"), "a\tb");
+
+    EXPECT_FALSE(HttpParser::parse(std::string_view("GET / HTTP/1.1\r\nNo colon here\r\n\r\n"), view));
+    EXPECT_FALSE(HttpParser::parse(std::string_view("GET / HTTP/1.1\r\nHost : x\r\n\r\n"), view));
+    EXPECT_FALSE(HttpParser::parse(std::string_view("GET / HTTP/1.1\r\n: x\r\n\r\n"), view));
+    EXPECT_FALSE(HttpParser::parse(std::string_view("GET / HTTP/1.1\r\nX-Bad: a\x01b\r\n\r\n"), view));
+    EXPECT_FALSE(HttpParser::parse(std::string_view("GET / HTTP/1.1\r\nX-Bad: a\rb\r\n\r\n"), view));
+    EXPECT_FALSE(HttpParser::parse(std::string_view("G(T / HTTP/1.1\r\n\r\n"), view));
+}
+
+// Test that a request trickled in byte by byte, into a buffer that keeps
+// reallocating, parses the same as one read, and pipelined bytes are left over
+TEST(HttpParserTest, IncrementalParserResumesAcrossReads)
+{
+    std::string first = "GET /a.html HTTP/1.1\r\nHost: localhost\r\nConnection: keep-alive\r\n\r\n";
+    std::string wire = first + "GET /b.html HTTP/1.1\r\n\r\n";
+
+    HttpRequestParser parser;
+    HttpRequestView request;
+    std::string received;
+    size_t fed = 0;
+    HttpRequestParser::Status status = HttpRequestParser::Status::NeedMore;
+    while (status == HttpRequestParser::Status::NeedMore && fed < wire.size()) {
+        received.push_back(wire[fed++]);
+        received.shrink_to_fit();
+        status = parser.feed(received, request);
+    }
+    ASSERT_EQ(status, HttpRequestParser::Status::Complete);
+    EXPECT_EQ(fed, first.size());
+    EXPECT_EQ(parser.headerBytes(), first.size());
+    EXPECT_EQ(request.path, "/a.html");
+    EXPECT_EQ(request.getHeader("host"), "localhost");
+    EXPECT_EQ(request.getHeader("Connection"), "keep-alive");
+    EXPECT_GE(request.path.data(), received.data());
+    EXPECT_LT(request.path.data(), received.data() + received.size());
+
+    // A complete parse is sticky until reset
+    EXPECT_EQ(parser.feed(received, request), HttpRequestParser::Status::Complete);
+
+    // The pipelined request parses from what is left
+    parser.reset();
+    std::string rest = wire.substr(first.size());
+    EXPECT_EQ(parser.feed(rest, request), HttpRequestParser::Status::Complete);
+    EXPECT_EQ(request.path, "/b.html");
+    EXPECT_EQ(request.header_count, 0u);
+}
+
+// Test that the incremental parser answers bad heads with the right status
+TEST(HttpParserTest, IncrementalParserErrors)
+{
+    HttpRequestParser parser;
+    HttpRequestView request;
+
+    EXPECT_EQ(parser.feed("GET / HTTP/1.1\r\nBad Header\r\n", request), HttpRequestParser::Status::Error);
+    EXPECT_EQ(parser.errorStatus(), 400);
+
+    // Leading empty lines are skipped
+    parser.reset();
+    EXPECT_EQ(parser.feed("\r\nGET / HTTP/1.1\r\n\r\n", request), HttpRequestParser::Status::Complete);
+
+    parser.reset();
+    std::string long_line = "GET /" + std::string(HttpRequestParser::kMaxRequestLineBytes, 'a');
+    EXPECT_EQ(parser.feed(long_line, request), HttpRequestParser::Status::Error);
+    EXPECT_EQ(parser.errorStatus(), 414);
+
+    parser.reset();
+    std::string many_headers = "GET / HTTP/1.1\r\n";
+    for (size_t i = 0; i <= HttpRequestView::kMaxHeaders; i++) {
+        many_headers += "X-" + std::to_string(i) + ": v\r\n";
+    }
+    EXPECT_EQ(parser.feed(many_headers, request), HttpRequestParser::Status::Error);
+    EXPECT_EQ(parser.errorStatus(), 431);
+
+    parser.reset();
+    std::string huge_header = "GET / HTTP/1.1\r\nCookie: " + std::string(HttpRequestParser::kMaxHeaderBytes, 'c');
+    EXPECT_EQ(parser.feed(huge_header, request), HttpRequestParser::Status::Error);
+    EXPECT_EQ(parser.errorStatus(), 431);
+}
+
+// Test that header names match in any case and well-known ones resolve to slots
+TEST(HttpParserTest, HeadersAreCaseInsensitiveWithWellKnownSlots)
+{
+    static_assert(HttpHeaderNames::lookup("accept-encoding") == HttpHeader::AcceptEncoding);
+    static_assert(HttpHeaderNames::lookup("IF-NONE-MATCH") == HttpHeader::IfNoneMatch);
+    static_assert(HttpHeaderNames::lookup("X-Forwarded-For") == HttpHeader::Other);
+    static_assert(HttpHeaderNames::lookup("Hosts") == HttpHeader::Other);
+
+    // A lowercase Connection header used to be missed by wantsKeepAlive
+    HttpRequest request("GET", "/");
+    request.setVersion("HTTP/1.0");
+    request.setHeader("connection", "keep-alive");
+    EXPECT_TRUE(request.wantsKeepAlive());
+    EXPECT_EQ(request.getHeader("Connection"), "keep-alive");
+    EXPECT_EQ(request.getHeader(HttpHeader::Connection), "keep-alive");
+
+    request.setHeader("CONNECTION", "close");
+    EXPECT_FALSE(request.wantsKeepAlive());
+    EXPECT_EQ(request.getHeaders().size(), 1u);
+
+    request.setHeader("x-custom", "1");
+    EXPECT_TRUE(request.hasHeader("X-Custom"));
+    EXPECT_FALSE(request.hasHeader(HttpHeader::Range));
+
+    HttpRequestView view;
+    ASSERT_TRUE(HttpParser::parse(std::string_view(
+        "GET /f HTTP/1.1\r\nhost: a\r\nRANGE: bytes=0-9\r\nHost: b\r\nContent-length: 0\r\n\r\n"), view));
+    EXPECT_EQ(view.getHeader(HttpHeader::Host), "a");  // First occurrence
+    EXPECT_EQ(view.getHeader(HttpHeader::Range), "bytes=0-9");
+    EXPECT_EQ(view.getHeader(HttpHeader::ContentLength), "0");
+    EXPECT_FALSE(view.hasHeader(HttpHeader::IfNoneMatch));
+    EXPECT_EQ(view.getHeader("If-None-Match"), "");
+    EXPECT_EQ(view.toRequest().getHeader(HttpHeader::Host), "a");
+}
+
+// Test that the request line's method and version resolve to enums once
+TEST(HttpParserTest, MethodAndVersionResolveToEnums)
+{
+    static_assert(HttpMethodNames::lookup("GET") == HttpMethod::Get);
+    static_assert(HttpMethodNames::lookup("OPTIONS") == HttpMethod::Options);
+    static_assert(HttpMethodNames::lookup("CONNECT") == HttpMethod::Connect);
+    static_assert(HttpMethodNames::lookup("get") == HttpMethod::Other);  // Case-sensitive
+    static_assert(HttpMethodNames::lookup("GOT") == HttpMethod::Other);
+    static_assert(HttpMethodNames::lookup("DELETES") == HttpMethod::Other);
+    static_assert(HttpMethodNames::lookupVersion("HTTP/1.0") == HttpVersion::Http10);
+    static_assert(HttpMethodNames::lookupVersion("HTTP/2.0") == HttpVersion::Other);
+    static_assert(HttpMethodNames::lookupVersion("http/1.1") == HttpVersion::Other);
+    for (HttpMethod method : {HttpMethod::Get, HttpMethod::Head, HttpMethod::Post, HttpMethod::Put,
+                              HttpMethod::Delete, HttpMethod::Options, HttpMethod::Connect,
+                              HttpMethod::Patch, HttpMethod::Trace}) {
+        EXPECT_EQ(HttpMethodNames::lookup(HttpMethodNames::name(method)), method);
+    }
+
+    HttpRequestView view;
+    ASSERT_TRUE(HttpParser::parse(std::string_view("DELETE /item HTTP/1.0\r\n\r\n"), view));
+    EXPECT_EQ(view.method_id, HttpMethod::Delete);
+    EXPECT_EQ(view.version_id, HttpVersion::Http10);
+    EXPECT_TRUE(view.isValid());
+    EXPECT_FALSE(view.isHttp11());
+    EXPECT_TRUE(view.toRequest().isDELETE());
+
+    ASSERT_TRUE(HttpParser::parse(std::string_view("PATCH /item HTTP/1.1\r\n\r\n"), view));
+    EXPECT_EQ(view.method_id, HttpMethod::Patch);
+    EXPECT_FALSE(view.isValid());  // Parsed, but not served
+
+    HttpRequest request("POST", "/form");
+    EXPECT_TRUE(request.isPOST());
+    EXPECT_TRUE(request.isHttp11());
+    request.setMethod("PUT");
+    request.setVersion("HTTP/1.0");
+    EXPECT_EQ(request.getMethodId(), HttpMethod::Put);
+    EXPECT_FALSE(request.isHttp11());
+    EXPECT_FALSE(request.wantsKeepAlive());
+}
+
+// Collects a decoded body for the framing tests
+class CollectedBody : public HttpBodyHandler {
+    public:
+        std::string data;
+        size_t limit = SIZE_MAX;
+
+        bool onBodyData(std::string_view piece) override {
+            data.append(piece);
+            return data.size() <= limit;
+        }
+        HttpResponse onBodyComplete() override { return HttpResponse("HTTP/1.1 201 Created\r\n\r\n"); }
+        HttpResponse onBodyError() override { return HttpResponse("HTTP/1.1 413 Content Too Large\r\n\r\n"); }
+};
+
+// Test that Content-Length and chunked bodies decode the same however they
+// are split across reads, and that bytes after the body are left alone
+TEST(HttpParserTest, BodyFramingAcrossReads)
+{
+    auto decodeInPieces = [](const std::string& wire, size_t piece_size, std::string& body, std::string& rest) {
+        HttpRequestView request;
+        HttpRequestParser parser;
+        if (parser.feed(wire, request) != HttpRequestParser::Status::Complete) {
+            return HttpBodyDecoder::Status::Error;
+        }
+        HttpBodyDecoder decoder;
+        if (!decoder.start(request)) {
+            return HttpBodyDecoder::Status::Error;
+        }
+        CollectedBody collected;
+        HttpBodyDecoder::Status status = decoder.status();
+        size_t position = parser.headerBytes();
+        while (status == HttpBodyDecoder::Status::NeedMore && position < wire.size()) {
+            size_t consumed = 0;
+            std::string_view piece = std::string_view(wire).substr(position, piece_size);
+            status = decoder.decode(piece, consumed, &collected);
+            position += consumed;
+        }
+        body = collected.data;
+        rest = wire.substr(position);
+        return status;
+    };
+
+    const std::string next = "GET /next HTTP/1.1\r\n\r\n";
+    const std::string sized = "PUT /upload/a HTTP/1.1\r\nContent-Length: 12\r\n\r\nhello\r\nworld" + next;
+    const std::string chunked = "POST /upload/a HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+                                "5;name=value\r\nhello\r\n7\r\n\r\nworld\r\n0\r\nX-Trailer: 1\r\n\r\n" + next;
+    for (const std::string& wire : {sized, chunked}) {
+        for (size_t piece_size : {1, 3, 7, 4096}) {
+            std::string body, rest;
+            EXPECT_EQ(decodeInPieces(wire, piece_size, body, rest), HttpBodyDecoder::Status::Complete) << piece_size;
+            EXPECT_EQ(body, "hello\r\nworld");
+            EXPECT_EQ(rest, next);
+        }
+    }
+
+    // No framing headers: no body, and a pipelined request follows directly
+    std::string body, rest;
+    EXPECT_EQ(decodeInPieces("GET / HTTP/1.1\r\n\r\n" + next, 4096, body, rest), HttpBodyDecoder::Status::Complete);
+    EXPECT_EQ(rest, next);
+
+    // Malformed chunks
+    for (const char* bad : {"zz\r\n", "5\r\nhelloX\r\n", "\r\n", "fffffffffffffffff\r\n"}) {
+        EXPECT_EQ(decodeInPieces(std::string("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n") + bad,
+                                 4096, body, rest), HttpBodyDecoder::Status::Error) << bad;
+    }
+
+    // Framing the server refuses to guess at
+    auto startStatus = [](const char* wire) {
+        HttpRequestView request;
+        HttpParser::parse(std::string_view(wire), request);
+        HttpBodyDecoder decoder;
+        return decoder.start(request) ? 0 : decoder.errorStatus();
+    };
+    EXPECT_EQ(startStatus("POST / HTTP/1.1\r\nContent-Length: 5\r\nContent-Length: 6\r\n\r\n"), 400);
+    EXPECT_EQ(startStatus("POST / HTTP/1.1\r\nContent-Length: 5\r\ncontent-length: 5\r\n\r\n"), 0);
+    EXPECT_EQ(startStatus("POST / HTTP/1.1\r\nContent-Length: -1\r\n\r\n"), 400);
+    EXPECT_EQ(startStatus("POST / HTTP/1.1\r\nContent-Length: 5\r\nTransfer-Encoding: chunked\r\n\r\n"), 400);
+    EXPECT_EQ(startStatus("POST / HTTP/1.1\r\nTransfer-Encoding: gzip, chunked\r\n\r\n"), 501);
+    EXPECT_EQ(startStatus("POST / HTTP/1.1\r\nTransfer-Encoding: gzip\r\n\r\n"), 400);
+    EXPECT_EQ(startStatus("POST / HTTP/1.0\r\nTransfer-Encoding: chunked\r\n\r\n"), 400);
+
+    // A handler that stops reading ends the body with Error, status 0
+    HttpRequestView request;
+    ASSERT_TRUE(HttpParser::parse(std::string_view("PUT / HTTP/1.1\r\nContent-Length: 10\r\n\r\n"), request));
+    HttpBodyDecoder decoder;
+    ASSERT_TRUE(decoder.start(request));
+    CollectedBody limited;
+    limited.limit = 4;
+    size_t consumed = 0;
+    EXPECT_EQ(decoder.decode("0123456789", consumed, &limited), HttpBodyDecoder::Status::Error);
+    EXPECT_EQ(decoder.errorStatus(), 0);
+}
+
+// Test that uploads stream into place and a cut-off upload leaves nothing behind
+TEST(HttpParserTest, UploadHandlerStreamsBodiesToDisk)
+{
+    std::string root = "/tmp/webserver_upload_test_" + std::to_string(getpid());
+    UploadHandler uploads;
+    ASSERT_TRUE(uploads.configure(root, 1024));
+
+    auto startUpload = [&](const std::string& head, HttpBodyDecoder& decoder, HttpResponse& rejection,
+                           HttpRequestView& request) {
+        EXPECT_TRUE(HttpParser::parse(std::string_view(head), request));
+        EXPECT_TRUE(uploads.handles(request));
+        EXPECT_TRUE(decoder.start(request));
+        return uploads.begin(request, decoder, rejection);
+    };
+    auto statusOf = [](const HttpResponse& response) { return response.toString().substr(9, 3); };
+
+    HttpRequestView request;
+    HttpBodyDecoder decoder;
+    HttpResponse response;
+    auto upload = startUpload("PUT /upload/notes.txt HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n",
+                              decoder, response, request);
+    ASSERT_NE(upload, nullptr);
+    size_t consumed = 0;
+    EXPECT_EQ(decoder.decode("4\r\nabcd\r\n", consumed, upload.get()), HttpBodyDecoder::Status::NeedMore);
+    EXPECT_FALSE(std::filesystem::exists(root + "/notes.txt"));  // Not in place until complete
+    EXPECT_EQ(decoder.decode("2\r\nef\r\n0\r\n\r\n", consumed, upload.get()), HttpBodyDecoder::Status::Complete);
+    EXPECT_EQ(statusOf(upload->onBodyComplete()), "201");
+    upload.reset();
+    std::ifstream stored(root + "/notes.txt");
+    EXPECT_EQ(std::string(std::istreambuf_iterator<char>(stored), {}), "abcdef");
+
+    // Over the limit while streaming: 413, and the partial file is removed
+    upload = startUpload("POST /upload/big.bin HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n",
+                         decoder, response, request);
+    ASSERT_NE(upload, nullptr);
+    std::string chunk = "800\r\n" + std::string(0x800, 'x') + "\r\n";
+    EXPECT_EQ(decoder.decode(chunk, consumed, upload.get()), HttpBodyDecoder::Status::Error);
+    EXPECT_EQ(statusOf(upload->onBodyError()), "413");
+    upload.reset();
+    EXPECT_FALSE(std::filesystem::exists(root + "/big.bin"));
+    EXPECT_EQ(std::distance(std::filesystem::directory_iterator(root), {}), 1);  // Only notes.txt
+
+    // Refused before reading: declared too large, no framing, bad name
+    EXPECT_EQ(startUpload("PUT /upload/a HTTP/1.1\r\nContent-Length: 2048\r\n\r\n", decoder, response, request), nullptr);
+    EXPECT_EQ(statusOf(response), "413");
+    EXPECT_EQ(startUpload("PUT /upload/a HTTP/1.1\r\n\r\n", decoder, response, request), nullptr);
+    EXPECT_EQ(statusOf(response), "411");
+    EXPECT_EQ(startUpload("PUT /upload/../a HTTP/1.1\r\nContent-Length: 1\r\n\r\n", decoder, response, request), nullptr);
+    EXPECT_EQ(statusOf(response), "400");
+
+    std::filesystem::remove_all(root);
+}
+
+// Test that responses are built with a correctly formatted, current Date
+TEST(HttpResponseTest, BuilderWritesHeadersWithCachedDate)
+{
+    char formatted[HttpDate::kLength];
+    HttpDate::format(784111777, formatted);
+    EXPECT_EQ(std::string_view(formatted, HttpDate::kLength), "Sun, 06 Nov 1994 08:49:37 GMT");
+    HttpDate::format(951782400, formatted);  // Leap day
+    EXPECT_EQ(std::string_view(formatted, HttpDate::kLength), "Tue, 29 Feb 2000 00:00:00 GMT");
+
+    // The cached value trails the clock by at most the timer's wake-up
+    std::time_t before = std::time(nullptr);
+    std::string date(HttpDate::now());
+    std::time_t after = std::time(nullptr);
+    bool matches = false;
+    for (std::time_t t = before - 1; t <= after; t++) {
+        HttpDate::format(t, formatted);
+        matches = matches || date == std::string_view(formatted, HttpDate::kLength);
+    }
+    EXPECT_TRUE(matches) << date;
+
+    std::string response = "stale contents";
+    ResponseBuilder(response, 5).status(201, "Created").header("Content-Type", "text/plain")
+        .header("X-Count", uint64_t{18446744073709551615ull}).standardHeaders().body("hello");
+    EXPECT_EQ(response, "HTTP/1.1 201 Created\r\nContent-Type: text/plain\r\n"
+                        "X-Count: 18446744073709551615\r\nDate: " + std::string(HttpDate::now()) +
+                        "\r\nServer: CustomHTTPServer/1.0\r\nConnection: close\r\n"
+                        "Content-Length: 5\r\n\r\nhello");
+
+    // Every generated page carries it, and keep-alive rewriting leaves it alone
+    HttpResponse page = ResponseGenerator::create404Response();
+    page.setConnection(true, 5, 100);
+    std::string text = page.toString();
+    EXPECT_NE(text.find("\r\nDate: "), std::string::npos);
+    EXPECT_NE(text.find("\r\nConnection: keep-alive\r\n"), std::string::npos);
+    EXPECT_EQ(text.find("Connection: close"), std::string::npos);
+}
+
+// Test that static pages are served from shared prebuilt bodies, gzipped on request
+TEST(HttpResponseTest, StaticPagesArePrebuiltWithGzipVariants)
+{
+    EXPECT_TRUE(StaticResponses::acceptsGzip("gzip, deflate, br, zstd"));
+    EXPECT_TRUE(StaticResponses::acceptsGzip("br;q=1.0, GZIP;q=0.5"));
+    EXPECT_TRUE(StaticResponses::acceptsGzip("*"));
+    EXPECT_FALSE(StaticResponses::acceptsGzip(""));
+    EXPECT_FALSE(StaticResponses::acceptsGzip("identity, br"));
+    EXPECT_FALSE(StaticResponses::acceptsGzip("gzip;q=0, *"));
+    EXPECT_FALSE(StaticResponses::acceptsGzip("*, gzip; q=0.000"));
+    EXPECT_FALSE(StaticResponses::acceptsGzip("gzipped"));
+
+    auto gunzip = [](const std::string& compressed) {
+        z_stream stream{};
+        EXPECT_EQ(inflateInit2(&stream, 15 + 16), Z_OK);
+        std::string plain(1 << 20, '\0');
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+        stream.avail_in = static_cast<uInt>(compressed.size());
+        stream.next_out = reinterpret_cast<Bytef*>(plain.data());
+        stream.avail_out = static_cast<uInt>(plain.size());
+        EXPECT_EQ(inflate(&stream, Z_FINISH), Z_STREAM_END);
+        plain.resize(stream.total_out);
+        inflateEnd(&stream);
+        return plain;
+    };
+
+    StaticResponses pages;
+    HttpRequestView plain_get, gzip_get, head;
+    ASSERT_TRUE(HttpParser::parse(std::string_view("GET /about HTTP/1.1\r\n\r\n"), plain_get));
+    ASSERT_TRUE(HttpParser::parse(std::string_view("GET /about HTTP/1.1\r\nAccept-Encoding: gzip\r\n\r\n"), gzip_get));
+    ASSERT_TRUE(HttpParser::parse(std::string_view("HEAD /about HTTP/1.1\r\n\r\n"), head));
+
+    // The body is shared, not rebuilt or copied, and matches the generator's page
+    HttpResponse first = pages.serve(StaticResponses::Page::About, plain_get);
+    HttpResponse second = pages.serve(StaticResponses::Page::About, plain_get);
+    ASSERT_NE(first.body, nullptr);
+    EXPECT_EQ(first.body, second.body);
+    EXPECT_EQ(first.body->toString(), ResponseGenerator::aboutPageHtml());
+    EXPECT_NE(first.head.find("\r\nContent-Length: " + std::to_string(first.body->size()) + "\r\n"),
+              std::string::npos);
+    EXPECT_NE(first.head.find("\r\nVary: Accept-Encoding\r\n"), std::string::npos);
+    EXPECT_EQ(first.head.find("Content-Encoding"), std::string::npos);
+
+    HttpResponse compressed = pages.serve(StaticResponses::Page::About, gzip_get);
+    ASSERT_NE(compressed.body, nullptr);
+    EXPECT_LT(compressed.body->size(), first.body->size());
+    EXPECT_NE(compressed.head.find("\r\nContent-Encoding: gzip\r\n"), std::string::npos);
+    EXPECT_EQ(gunzip(compressed.body->toString()), ResponseGenerator::aboutPageHtml());
+
+    // HEAD: the GET's headers and no body
+    HttpResponse head_only = pages.serve(StaticResponses::Page::About, head);
+    EXPECT_EQ(head_only.body, nullptr);
+    EXPECT_NE(head_only.head.find("\r\nContent-Length: " + std::to_string(first.body->size()) + "\r\n"),
+              std::string::npos);
+
+    HttpResponse not_found = pages.serve(StaticResponses::Page::NotFound, plain_get);
+    EXPECT_EQ(not_found.head.substr(0, 24), "HTTP/1.1 404 Not Found\r\n");
+    EXPECT_EQ(not_found.body->toString(), ResponseGenerator::errorPageHtml(404));
+    HttpResponse not_allowed = pages.serve(StaticResponses::Page::MethodNotAllowed, plain_get);
+    EXPECT_EQ(not_allowed.head.substr(0, 33), "HTTP/1.1 405 Method Not Allowed\r\n");
+    EXPECT_NE(not_allowed.head.find("\r\nAllow: GET, HEAD\r\n"), std::string::npos);
+}
+
+// Test that a crawler walking cold files does not flush the hot set
+TEST(FileCacheTest, TinyLFUResistsScans)
+{
+    LRUFileCache cache(1, 1, CachePolicyType::WTinyLFU);
+    std::string body(100 * 1024, 'x');
+
+    for (int round = 0; round < 5; ++round) {
+        for (int i = 0; i < 4; ++i) {
+            std::string key = "/hot" + std::to_string(i) + ".css";
+            if (!cache.get(key)) {
+                cache.put(key, CachedFile(body, "text/css"));
+            }
+        }
+    }
+
+    for (int i = 0; i < 50; ++i) {
+        std::string key = "/cold" + std::to_string(i) + ".html";
+        if (!cache.get(key)) {
+            cache.put(key, CachedFile(body, "text/html"));
+        }
+    }
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_NE(cache.get("/hot" + std::to_string(i) + ".css"), nullptr);
+    }
+}
+
+// Test that the inotify watcher refreshes and invalidates cached files
+TEST(FileCacheTest, WatcherInvalidatesChangedFiles)
+{
+    std::string root = "/tmp/webserver_watch_test_" + std::to_string(getpid());
+    std::filesystem::create_directories(root);
+    auto writeFile = [&](const std::string& body) {
+        std::ofstream out(root + "/watched.txt", std::ios::trunc);
+        out << body;
+    };
+    auto waitFor = [](const std::function<bool()>& condition) {
+        for (int i = 0; i < 50 && !condition(); ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        return condition();
+    };
+
+    writeFile("version-1");
+    FileHandler handler(root);
+    ASSERT_TRUE(handler.startWatching());
+
+    auto& cache = FileCacheManager::get_instance();
+    EXPECT_NE(handler.serveFile("/watched.txt").toString().find("version-1"), std::string::npos);
+    EXPECT_TRUE(cache.contains("/watched.txt"));
+
+    writeFile("version-2");
+    EXPECT_TRUE(waitFor([&] {
+        auto cached = cache.get("/watched.txt");
+        return cached && cached->content == "version-2";
+    }));
+
+    // Grown past the cache's file size limit: the old version must go, from
+    // the shared cache and from this thread's L1
+    writeFile(std::string(cache.getMaxFileSize() + 1, 'g'));
+    EXPECT_TRUE(waitFor([&] { return !cache.contains("/watched.txt"); }));
+    EXPECT_EQ(handler.serveFile("/watched.txt").toString().find("version-2"), std::string::npos);
+
+    std::filesystem::remove(root + "/watched.txt");
+    EXPECT_TRUE(waitFor([&] { return !cache.contains("/watched.txt"); }));
+
+    handler.stopWatching();
+    std::filesystem::remove_all(root);
+}
+
+// Test that pinned entries survive eviction pressure
+TEST(FileCacheTest, PinnedEntriesAreNeverEvicted)
+{
+    LRUFileCache cache(1, 1, CachePolicyType::LRU);
+    std::string body(200 * 1024, 'x');
+
+    ASSERT_TRUE(cache.put("/pinned.css", CachedFile(body, "text/css"), true));
+    for (int i = 0; i < 20; ++i) {
+        cache.put("/file" + std::to_string(i) + ".html", CachedFile(body, "text/html"));
+    }
+
+    EXPECT_TRUE(cache.contains("/pinned.css"));
+    EXPECT_EQ(cache.getStats().pinned_bytes, body.size());
+    EXPECT_LE(cache.getStats().size_bytes, cache.getStats().capacity_bytes);
+}
+
+// Test that an update the cache refuses leaves the cached version in place
+TEST(FileCacheTest, RejectedUpdateKeepsOldEntry)
+{
+    LRUFileCache cache(1, 1, CachePolicyType::LRU);
+    ASSERT_TRUE(cache.put("/a.css", CachedFile(std::string(600 * 1024, 'a'), "text/css"), true));
+    ASSERT_TRUE(cache.put("/b.css", CachedFile(std::string(200 * 1024, 'b'), "text/css"), true));
+
+    // The pin carries over to the update, and 600KB + 500KB pinned does not fit
+    EXPECT_FALSE(cache.put("/b.css", CachedFile(std::string(500 * 1024, 'c'), "text/css")));
+    auto kept = cache.get("/b.css");
+    ASSERT_NE(kept, nullptr);
+    EXPECT_EQ(kept->size_bytes, 200u * 1024);
+
+    // Refused by the admission filter: a once-seen key against a hot main area
+    LRUFileCache filtered(1, 1, CachePolicyType::WTinyLFU);
+    std::string body(100 * 1024, 'x');
+    ASSERT_TRUE(filtered.put("/page.html", CachedFile(body, "text/html")));
+    for (int round = 0; round < 5; ++round) {
+        for (int i = 0; i < 8; ++i) {
+            std::string key = "/hot" + std::to_string(i) + ".css";
+            if (!filtered.get(key)) {
+                filtered.put(key, CachedFile(body, "text/css"));
+            }
+        }
+    }
+    ASSERT_TRUE(filtered.contains("/page.html"));
+    EXPECT_FALSE(filtered.put("/page.html", CachedFile(std::string(150 * 1024, 'y'), "text/html")));
+    ASSERT_TRUE(filtered.contains("/page.html"));
+    EXPECT_EQ(filtered.peek("/page.html")->size_bytes, body.size());
+}
+
+// Test parallel warm-up from a manifest
+TEST(FileCacheTest, WarmupFromManifest)
+{
+    std::string root = "/tmp/webserver_warmup_test_" + std::to_string(getpid());
+    std::filesystem::create_directories(root + "/css");
+    std::ofstream(root + "/warm.html") << "<html>warm</html>";
+    std::ofstream(root + "/css/warm.css") << "body {}";
+    std::ofstream(root + "/manifest.txt") << "# warm-up list\n/warm.html pin\n/css/warm.css\n/missing.js\n";
+
+    FileHandler handler(root);
+    ThreadPool pool(2);
+    WarmupReport report = handler.warmCache(pool, root + "/manifest.txt");
+
+    EXPECT_EQ(report.files_loaded, 2u);
+    EXPECT_EQ(report.files_pinned, 1u);
+    EXPECT_EQ(report.files_failed, 1u);
+    EXPECT_EQ(report.bytes_loaded, 24u);
+
+    auto& cache = FileCacheManager::get_instance();
+    EXPECT_TRUE(cache.contains("/warm.html"));
+    EXPECT_TRUE(cache.contains("/css/warm.css"));
+
+    cache.remove("/warm.html");
+    cache.remove("/css/warm.css");
+    std::filesystem::remove_all(root);
+}
+
+// Test that the document index answers existence/MIME lookups and follows the disk
+TEST(FileCacheTest, DocumentIndexTracksDocumentRoot)
+{
+    std::string root = "/tmp/webserver_index_test_" + std::to_string(getpid());
+    std::filesystem::create_directories(root + "/css");
+    std::ofstream(root + "/css/site.css") << "body {}";
+
+    FileHandler handler(root);
+    ASSERT_TRUE(handler.startWatching());
+
+    auto document = handler.getDocumentIndex().lookup("/css/site.css");
+    ASSERT_NE(document, nullptr);
+    EXPECT_EQ(document->mime_type, "text/css");
+    EXPECT_EQ(document->size_bytes, 7u);
+    EXPECT_FALSE(document->etag.empty());
+    EXPECT_FALSE(handler.canServeFile("/about"));
+    EXPECT_FALSE(handler.canServeFile("/css"));
+
+    std::ofstream(root + "/new.js") << "let x;";
+    bool indexed = false;
+    for (int i = 0; i < 50 && !indexed; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        indexed = handler.canServeFile("/new.js");
+    }
+    EXPECT_TRUE(indexed);
+
+    handler.stopWatching();
+    std::filesystem::remove_all(root);
+}
+
+// Test that a file deleted behind an unwatched index gets a 404 and leaves the index
+TEST(FileCacheTest, DeletedFileWithoutWatcherIsNotFound)
+{
+    std::string root = "/tmp/webserver_unwatched_test_" + std::to_string(getpid());
+    std::filesystem::create_directories(root);
+    std::ofstream(root + "/gone.txt") << "soon deleted";
+
+    FileHandler handler(root);
+    ASSERT_TRUE(handler.canServeFile("/gone.txt"));
+    FileCacheManager::get_instance().remove("/gone.txt");
+    std::filesystem::remove(root + "/gone.txt");
+
+    EXPECT_EQ(handler.serveFile("/gone.txt").toString().substr(9, 3), "404");
+    EXPECT_FALSE(handler.getDocumentIndex().contains("/gone.txt"));
+    EXPECT_FALSE(handler.canServeFile("/gone.txt"));
+
+    std::filesystem::remove_all(root);
+}
+
+// Test that concurrent misses for one key run the loader once and share the result
+TEST(FileCacheTest, SingleFlightCoalescesConcurrentMisses)
+{
+    LRUFileCache cache(1, 1);
+    std::atomic<int> loader_calls{0};
+    auto loader = [&]() -> std::shared_ptr<const CachedFile> {
+        loader_calls++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        return std::make_shared<const CachedFile>("shared body", "text/plain");
+    };
+
+    std::vector<std::shared_ptr<const CachedFile>> results(8);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < results.size(); ++i) {
+        threads.emplace_back([&, i] { results[i] = cache.load("/popular.txt", loader); });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(loader_calls.load(), 1);
+    for (const auto& result : results) {
+        EXPECT_EQ(result, results[0]);
+    }
+    EXPECT_EQ(cache.getStats().loads_coalesced, results.size() - 1);
+
+    // A failed load is delivered to every waiter
+    loader_calls = 0;
+    auto failing_loader = [&]() -> std::shared_ptr<const CachedFile> {
+        loader_calls++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        throw std::runtime_error("read failed");
+    };
+    std::atomic<int> failures{0};
+    threads.clear();
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&] {
+            try {
+                cache.load("/broken.txt", failing_loader);
+            } catch (const std::runtime_error&) {
+                failures++;
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(loader_calls.load(), 1);
+    EXPECT_EQ(failures.load(), 4);
+    EXPECT_FALSE(cache.contains("/broken.txt"));
+}
+
+// Test that a snapshot restores entries, order and pins, and drops stale ones lazily
+TEST(FileCacheTest, SnapshotRoundTrip)
+{
+    std::string path = "/tmp/webserver_snapshot_test_" + std::to_string(getpid());
+    LRUFileCache original(1, 1, CachePolicyType::LRU);
+    original.put("/pinned.js", CachedFile("pinned", "application/javascript", "\"p1\""), true);
+    original.put("/a.html", CachedFile("aaa", "text/html", "\"a1\""));
+    original.put("/b.css", CachedFile("bbb", "text/css", "\"b1\""));
+    original.get("/a.html");
+    ASSERT_TRUE(CacheSnapshot::save(original, path).ok);
+
+    LRUFileCache restored(1, 1, CachePolicyType::LRU);
+    auto result = CacheSnapshot::load(restored, path);
+    ASSERT_TRUE(result.ok);
+    EXPECT_EQ(result.entries, 3u);
+
+    auto before = original.exportEntries();
+    auto after = restored.exportEntries();
+    ASSERT_EQ(before.size(), after.size());
+    for (size_t i = 0; i < before.size(); ++i) {
+        EXPECT_EQ(before[i].key, after[i].key);
+        EXPECT_EQ(before[i].pinned, after[i].pinned);
+    }
+
+    // "/b.css" changed on disk since the snapshot was taken
+    restored.setValidator([](const std::string& key, const CachedFile&) { return key != "/b.css"; });
+    auto file = restored.get("/a.html");
+    ASSERT_NE(file, nullptr);
+    EXPECT_EQ(file->content, "aaa");
+    EXPECT_EQ(file->etag, "\"a1\"");
+    EXPECT_EQ(restored.get("/b.css"), nullptr);
+    EXPECT_FALSE(restored.contains("/b.css"));
+
+    // An entry count the file cannot hold is rejected, not reserved
+    {
+        std::fstream corrupt(path, std::ios::in | std::ios::out | std::ios::binary);
+        uint32_t huge_count = 0xFFFFFFFFu;
+        corrupt.seekp(12);
+        corrupt.write(reinterpret_cast<const char*>(&huge_count), sizeof(huge_count));
+    }
+    LRUFileCache rejected(1, 1, CachePolicyType::LRU);
+    EXPECT_FALSE(CacheSnapshot::load(rejected, path).ok);
+    EXPECT_TRUE(rejected.exportEntries().empty());
+
+    std::remove(path.c_str());
+}
+
+// Test that slab accounting bounds the cache and churned memory is given back
+TEST(FileCacheTest, SlabStorageBoundsMemory)
+{
+    auto& slab = SlabAllocator::instance();
+    auto before = slab.getStats();
+    {
+        LRUFileCache cache(2, 1, CachePolicyType::LRU);
+        for (int i = 0; i < 400; ++i) {
+            size_t size = 1024 + (i * 7919) % (300 * 1024);
+            cache.put("/churn" + std::to_string(i % 120), CachedFile(std::string(size, 'x'), "text/plain"));
+
+            auto stats = cache.getStats();
+            ASSERT_LE(stats.memory_bytes, stats.capacity_bytes);
+            ASSERT_GT(stats.memory_bytes, stats.size_bytes);
+        }
+
+        auto during = slab.getStats();
+        EXPECT_GE(during.allocated_bytes - before.allocated_bytes,
+                  during.payload_bytes - before.payload_bytes);
+    }
+
+    // Every block freed and every emptied arena unmapped
+    auto after = slab.getStats();
+    EXPECT_EQ(after.payload_bytes, before.payload_bytes);
+    EXPECT_EQ(after.allocated_bytes, before.allocated_bytes);
+    EXPECT_LE(after.mapped_bytes, before.mapped_bytes);
+}
+
+// Test that the cache budget follows cgroup headroom and PSI within its bounds
+TEST(FileCacheTest, MemoryPressureResizesCache)
+{
+    std::string dir = "/tmp/webserver_cgroup_test_" + std::to_string(getpid());
+    std::filesystem::create_directories(dir);
+    auto writeSample = [&](size_t usage_mb, double avg10) {
+        std::ofstream(dir + "/memory.max") << (200 * 1024 * 1024) << "\n";
+        std::ofstream(dir + "/memory.current") << (usage_mb * 1024 * 1024) << "\n";
+        std::ofstream(dir + "/pressure") << "some avg10=" << avg10 << " avg60=0.00 avg300=0.00 total=1\n"
+                                         << "full avg10=0.00 avg60=0.00 avg300=0.00 total=0\n";
+    };
+
+    LRUFileCache cache(64, 1, CachePolicyType::LRU);
+    std::string body(512 * 1024, 'x');
+    for (int i = 0; i < 100; ++i) {
+        cache.put("/file" + std::to_string(i), CachedFile(body, "text/plain"));
+    }
+    size_t entries_before = cache.getStats().entries;
+
+    MemoryPressureMonitor::Config config;
+    config.floor_bytes = 16 * 1024 * 1024;
+    config.ceiling_bytes = 80 * 1024 * 1024;
+    config.cgroup_dir = dir;
+    config.pressure_path = dir + "/pressure";
+    MemoryPressureMonitor monitor(cache, config);
+
+    // Stalling on memory: one shrink step, evicted in a single batch
+    writeSample(150, 25.0);
+    size_t shrunk = monitor.adjust();
+    EXPECT_EQ(shrunk, 48u * 1024 * 1024);
+    EXPECT_LT(cache.getStats().entries, entries_before);
+    EXPECT_LE(cache.getStats().memory_bytes, shrunk);
+
+    // Almost out of headroom: never below the floor
+    for (int i = 0; i < 10; ++i) {
+        writeSample(195, 50.0);
+        monitor.adjust();
+    }
+    EXPECT_EQ(cache.getStats().capacity_bytes, config.floor_bytes);
+
+    // Pressure gone and plenty of room: grow back, capped at the ceiling
+    for (int i = 0; i < 50; ++i) {
+        writeSample(40, 0.0);
+        monitor.adjust();
+    }
+    EXPECT_EQ(cache.getStats().capacity_bytes, config.ceiling_bytes);
+
+    std::filesystem::remove_all(dir);
+}
+
+// Test that the thread-local L1 serves repeat hits and drops invalidated files
+TEST(FileCacheTest, L1ServesHotFilesAndFollowsInvalidation)
+{
+    LRUFileCache cache(1, 1, CachePolicyType::LRU);
+    L1FileCache& l1 = L1FileCache::local();
+    cache.put("/hot.css", CachedFile("v1", "text/css"));
+
+    for (int i = 0; i < 10; ++i) {
+        auto file = l1.get(cache, "/hot.css");
+        ASSERT_NE(file, nullptr);
+        EXPECT_EQ(file->content, "v1");
+    }
+    l1.flushStats(cache);
+    auto stats = cache.getStats();
+    EXPECT_EQ(stats.l1_hits, 9u);
+    EXPECT_EQ(stats.l1_misses, 1u);
+    EXPECT_EQ(stats.hits, 1u);  // Only the first lookup reached the shared cache
+
+    // Replacing the file moves the epoch, so the L1 must not serve v1 again
+    cache.put("/hot.css", CachedFile("v2", "text/css"));
+    EXPECT_EQ(l1.get(cache, "/hot.css")->content, "v2");
+
+    cache.remove("/hot.css");
+    EXPECT_EQ(l1.get(cache, "/hot.css"), nullptr);
+
+    // Evictions retire L1 copies too, or the L1 would keep the memory alive
+    cache.put("/evicted.css", CachedFile(std::string(100 * 1024, 'e'), "text/css"));
+    std::weak_ptr<const CachedFile> held = l1.get(cache, "/evicted.css");
+    ASSERT_FALSE(held.expired());
+    cache.put("/big.bin", CachedFile(std::string(950 * 1024, 'b'), "application/octet-stream"));
+    ASSERT_FALSE(cache.contains("/evicted.css"));
+    EXPECT_EQ(l1.get(cache, "/evicted.css"), nullptr);
+    EXPECT_TRUE(held.expired());
+
+    cache.put("/shrunk.css", CachedFile("s", "text/css"));
+    held = l1.get(cache, "/shrunk.css");
+    cache.setCapacity(0);
+    EXPECT_EQ(l1.get(cache, "/shrunk.css"), nullptr);
+    EXPECT_TRUE(held.expired());
+}
+
+// RCU backend: lock-free hits, invalidation, CLOCK eviction and reclamation
+TEST(FileCacheTest, RcuBackendServesAndEvictsWithoutLocks)
+{
+    LRUFileCache cache(1, 1, CachePolicyType::WTinyLFU, CacheBackend::RCU);
+    const std::string body(200 * 1024, 'x');
+    cache.put("/a", CachedFile(body, "text/plain"));
+    cache.put("/b", CachedFile(body, "text/plain"));
+    cache.put("/c", CachedFile(body, "text/plain"));
+    cache.put("/d", CachedFile(body, "text/plain"));
+
+    // Touch /a so CLOCK gives it a second chance over the others
+    ASSERT_NE(cache.get("/a"), nullptr);
+    EXPECT_EQ(cache.get("/missing"), nullptr);
+    auto stats = cache.getStats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.misses, 1u);
+
+    cache.put("/e", CachedFile(body, "text/plain"));
+    cache.put("/f", CachedFile(body, "text/plain"));
+    EXPECT_TRUE(cache.contains("/a"));
+    EXPECT_FALSE(cache.contains("/b"));
+    EXPECT_TRUE(cache.contains("/f"));
+
+    // A reader holding a handle keeps it valid across invalidation
+    auto held = cache.get("/a");
+    cache.put("/a", CachedFile("new", "text/plain"));
+    EXPECT_EQ(held->size_bytes, body.size());
+    EXPECT_EQ(cache.get("/a")->content, "new");
+    cache.remove("/a");
+    EXPECT_EQ(cache.get("/a"), nullptr);
+
+    cache.clear();
+    EXPECT_EQ(cache.get("/f"), nullptr);
+    EpochDomain::instance().reclaim();
+    EXPECT_EQ(EpochDomain::instance().pendingRetired(), 0u);
+}
+
+// Test that CLOCK still evicts when readers re-reference every entry mid-sweep
+TEST(FileCacheTest, ClockSweepIsBoundedUnderConstantReferences)
+{
+    ClockPolicy clock(300, [](SlotId) { return true; });
+    std::vector<SlotId> evicted;
+    for (SlotId slot = 0; slot < 3; ++slot) {
+        clock.onInsert(slot, slot, 100, evicted);
+    }
+    EXPECT_TRUE(evicted.empty());
+
+    clock.onInsert(3, 3, 100, evicted);
+    ASSERT_EQ(evicted.size(), 1u);
+    clock.setCapacity(100, evicted);
+    EXPECT_EQ(evicted.size(), 3u);
+    EXPECT_EQ(clock.slots().size(), 1u);
+}
+
+// Striped statistics: byte hit ratio, evictions, rejects and load latency
+TEST(FileCacheTest, StatsTrackBytesEvictionsRejectsAndLoads)
+{
+    LRUFileCache cache(1, 1, CachePolicyType::LRU);
+    const std::string body(300 * 1024, 'x');
+
+    auto loader = [&] { return std::make_shared<const CachedFile>(body, "text/plain"); };
+    ASSERT_EQ(cache.get("/a"), nullptr);
+    ASSERT_NE(cache.load("/a", loader), nullptr);
+    ASSERT_NE(cache.get("/a"), nullptr);
+    ASSERT_NE(cache.get("/a"), nullptr);
+
+    EXPECT_FALSE(cache.put("/huge", CachedFile(std::string(2 * 1024 * 1024, 'x'), "text/plain")));
+    cache.put("/b", CachedFile(body, "text/plain"));
+    cache.put("/c", CachedFile(body, "text/plain"));
+    cache.put("/d", CachedFile(body, "text/plain"));
+
+    auto stats = cache.getStats();
+    EXPECT_EQ(stats.hits, 2u);
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.hit_bytes, 2 * body.size());
+    EXPECT_EQ(stats.miss_bytes, body.size());
+    EXPECT_NEAR(stats.byte_hit_ratio, 2.0 / 3.0, 1e-9);
+    EXPECT_EQ(stats.rejects_too_large, 1u);
+    EXPECT_GE(stats.evictions, 1u);
+    EXPECT_EQ(stats.loads_executed, 1u);
+    EXPECT_GT(stats.avg_load_latency_us, 0.0);
+    EXPECT_GE(stats.max_load_latency_us, stats.avg_load_latency_us);
+
+    cache.clear();
+    stats = cache.getStats();
+    EXPECT_EQ(stats.hits + stats.misses + stats.evictions + stats.rejects_too_large, 0u);
+}
+
+// Large bodies are chains of slab segments, filled from disk and sent in place
+TEST(FileCacheTest, SegmentedBodiesAvoidContiguousCopies)
+{
+    const size_t segment = SegmentedBuffer::kSegmentBytes;
+    std::string body(3 * segment + 123, '\0');
+    for (size_t i = 0; i < body.size(); i++) {
+        body[i] = static_cast<char>('a' + i % 26);
+    }
+
+    std::string path = "/tmp/segmented_body_test.bin";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << body;
+    }
+    auto large_before = SlabAllocator::instance().getStats().large_mappings;
+    SegmentedBuffer buffer;
+    int fd = open(path.c_str(), O_RDONLY);
+    ASSERT_GE(fd, 0);
+    ASSERT_TRUE(buffer.readFrom(fd, body.size()));
+    close(fd);
+    std::remove(path.c_str());
+
+    EXPECT_EQ(buffer.size(), body.size());
+    EXPECT_EQ(buffer.segmentCount(), 4u);
+    EXPECT_EQ(buffer.segment(3).size(), 123u);
+    EXPECT_TRUE(buffer == body);
+    EXPECT_EQ(SlabAllocator::instance().getStats().large_mappings, large_before);
+
+    // A response resumed mid-body covers exactly the remaining bytes
+    auto file = std::make_shared<const CachedFile>(std::move(buffer), "application/octet-stream");
+    HttpResponse response("HEAD\r\n\r\n", std::shared_ptr<const SegmentedBuffer>(file, &file->content));
+    size_t offset = 8 + segment + 10;
+    std::vector<iovec> iov;
+    response.appendIovecs(iov, offset);
+    ASSERT_EQ(iov.size(), 3u);
+    std::string rest;
+    for (const auto& part : iov) {
+        rest.append(static_cast<const char*>(part.iov_base), part.iov_len);
+    }
+    EXPECT_EQ(rest, response.toString().substr(offset));
+    EXPECT_EQ(response.size(), 8 + body.size());
+}
+
+// Keep-alive requests for a cached file are parsed, answered and written by
+// Server::handleConnection entirely from the connection's arena, without
+// touching the global heap
+TEST(FileCacheTest, CachedHitMakesNoHeapAllocations)
+{
+    std::string root = "/tmp/webserver_arena_test_" + std::to_string(getpid());
+    std::filesystem::create_directories(root + "/assets");
+    {
+        std::ofstream out(root + "/assets/application.stylesheet.css");
+        out << std::string(20 * 1024, 'c');
+    }
+    Server server(0);
+    ServerTestAccess::fileHandler(server).setDocumentRoot(root);
+    const std::string wire =
+        "GET /assets/application.stylesheet.css HTTP/1.1\r\n"
+        "Host: localhost:8080\r\n"
+        "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36\r\n"
+        "Accept: text/css,*/*;q=0.1\r\n"
+        "Connection: keep-alive\r\n\r\n";
+
+    // Allocations for one connection carrying `requests` pipelined requests
+    auto serveConnection = [&](int requests, size_t& responses) {
+        std::string pipelined;
+        for (int i = 0; i < requests; ++i) {
+            pipelined += wire;
+        }
+        size_t allocations = 0;
+        std::string received = ServerTestAccess::exchange(server, pipelined, &allocations);
+        responses = 0;
+        for (size_t at = received.find("HTTP/1.1 200 OK\r\n"); at != std::string::npos;
+             at = received.find("HTTP/1.1 200 OK\r\n", at + 1)) {
+            responses++;
+        }
+        return allocations;
+    };
+
+    // The first connection loads the file into the shared cache and the L1
+    size_t responses = 0;
+    EXPECT_GT(serveConnection(2, responses), 0u);
+    EXPECT_EQ(responses, 2u);
+
+    // A connection costs the same whether it serves two hits or four: the
+    // extra requests allocate nothing
+    size_t two = serveConnection(2, responses);
+    EXPECT_EQ(responses, 2u);
+    size_t four = serveConnection(4, responses);
+    EXPECT_EQ(responses, 4u);
+    EXPECT_EQ(four, two);
+
+    FileCacheManager::get_instance().remove("/assets/application.stylesheet.css");
+    std::filesystem::remove_all(root);
+}
+
+// HEAD gets a file's headers, Content-Length included, and not one body byte,
+// so the next pipelined response starts right after them
+TEST(FileCacheTest, HeadRequestsGetNoBody)
+{
+    std::string root = "/tmp/webserver_head_test_" + std::to_string(getpid());
+    std::filesystem::create_directories(root);
+    {
+        std::ofstream out(root + "/head.txt");
+        out << std::string(5000, 'h');
+    }
+    Server server(0);
+    FileHandler& handler = ServerTestAccess::fileHandler(server);
+    handler.setDocumentRoot(root);
+
+    // From disk, then from the cache, then a missing file
+    for (int pass = 0; pass < 2; ++pass) {
+        HttpResponse head = handler.serveFile("/head.txt", std::pmr::get_default_resource(), true);
+        EXPECT_EQ(head.body, nullptr);
+        EXPECT_NE(head.head.find("\r\nContent-Length: 5000\r\n"), std::string::npos);
+        EXPECT_EQ(head.size(), head.head.find("\r\n\r\n") + 4);
+    }
+    HttpResponse missing = handler.serveFile("/missing.txt", std::pmr::get_default_resource(), true);
+    EXPECT_EQ(missing.toString().substr(9, 3), "404");
+    EXPECT_EQ(missing.size(), missing.head.find("\r\n\r\n") + 4);
+
+    // Through the connection loop: HEAD, then GET, on one keep-alive connection
+    std::string received = ServerTestAccess::exchange(server,
+        "HEAD /head.txt HTTP/1.1\r\nHost: localhost\r\n\r\n"
+        "GET /head.txt HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n");
+    size_t first_end = received.find("\r\n\r\n");
+    ASSERT_NE(first_end, std::string::npos);
+    EXPECT_EQ(received.compare(first_end + 4, 17, "HTTP/1.1 200 OK\r\n"), 0);
+    size_t second_end = received.find("\r\n\r\n", first_end + 4);
+    ASSERT_NE(second_end, std::string::npos);
+    EXPECT_EQ(received.substr(second_end + 4), std::string(5000, 'h'));
+
+    FileCacheManager::get_instance().remove("/head.txt");
+    std::filesystem::remove_all(root);
+}
+
+// TTL rules: expired entries are served stale while one background revalidation runs
+TEST(FileCacheTest, TtlServesStaleWhileRevalidating)
+{
+    TtlRules rules;
+    rules.add("/nfs/*", std::chrono::seconds(1));
+    rules.add("*.txt", std::chrono::milliseconds(0));
+    EXPECT_TRUE(rules.expired("/nfs/a/b.css", std::chrono::seconds(2)));
+    EXPECT_FALSE(rules.expired("/nfs/a/b.css", std::chrono::milliseconds(500)));
+    EXPECT_FALSE(rules.expired("/index.html", std::chrono::hours(24)));
+
+    std::string root = "/tmp/webserver_ttl_test_" + std::to_string(getpid());
+    std::filesystem::create_directories(root);
+    auto writeFile = [&](const std::string& body) {
+        std::ofstream out(root + "/ttl.txt", std::ios::trunc);
+        out << body;
+    };
+
+    writeFile("version-1");
+    FileHandler handler(root);
+    handler.setTtlRules(rules);
+    auto& cache = FileCacheManager::get_instance();
+    EXPECT_NE(handler.serveFile("/ttl.txt").toString().find("version-1"), std::string::npos);
+
+    // Not watched: the change is only noticed through the TTL, and the
+    // request that notices it still gets the stale copy without waiting
+    writeFile("version-2, longer");
+    EXPECT_NE(handler.serveFile("/ttl.txt").toString().find("version-1"), std::string::npos);
+
+    bool refreshed = false;
+    for (int i = 0; i < 50 && !refreshed; ++i) {
+        auto cached = cache.peek("/ttl.txt");
+        refreshed = cached && cached->content == "version-2, longer";
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    EXPECT_TRUE(refreshed);
+
+    cache.remove("/ttl.txt");
+    std::filesystem::remove_all(root);
+}
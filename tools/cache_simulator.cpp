@@ -0,0 +1,189 @@
+// Capacity planning for the file cache: replays an access log through the
+// cache's eviction policies at a sweep of capacities and max-file limits and
+// prints hit ratio and byte hit ratio for each combination.
+//
+//   cache_simulator TRACE [--policies lru,wtinylfu,clock]
+//                         [--capacities-mb 8,16,32,...] [--max-file-mb 1,5,20]
+//                         [--charge memory|payload] [--csv]
+//
+// TRACE is "<path> <bytes>" per line or a Common/Combined Log Format access
+// log ("-" reads stdin). Capacities default to doubling from 8MB until the
+// whole working set fits. With --charge memory (the default) entries are
+// charged what LRUFileCache charges them: slab blocks plus metadata.
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+#include "CacheSimulator.h"
+#include "FileCache.h"
+
+namespace {
+
+    std::vector<std::string> splitList(const std::string& list) {
+        std::vector<std::string> items;
+        std::stringstream stream(list);
+        std::string item;
+        while (std::getline(stream, item, ',')) {
+            if (!item.empty()) {
+                items.push_back(item);
+            }
+        }
+        return items;
+    }
+
+    bool parseSizes(const std::string& list, std::vector<size_t>& sizes_mb) {
+        sizes_mb.clear();
+        for (const auto& item : splitList(list)) {
+            try {
+                sizes_mb.push_back(std::stoul(item));
+            } catch (const std::exception&) {
+                return false;
+            }
+        }
+        return !sizes_mb.empty();
+    }
+
+    bool parsePolicies(const std::string& list, std::vector<CachePolicyType>& policies) {
+        policies.clear();
+        for (const auto& item : splitList(list)) {
+            if (item == "lru") {
+                policies.push_back(CachePolicyType::LRU);
+            } else if (item == "wtinylfu") {
+                policies.push_back(CachePolicyType::WTinyLFU);
+            } else if (item == "clock") {
+                policies.push_back(CachePolicyType::Clock);
+            } else {
+                return false;
+            }
+        }
+        return !policies.empty();
+    }
+
+    int usage() {
+        std::cerr << "Usage: cache_simulator TRACE [--policies lru,wtinylfu,clock]"
+                  << " [--capacities-mb LIST] [--max-file-mb LIST] [--charge memory|payload] [--csv]" << std::endl;
+        return 1;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        return usage();
+    }
+
+    std::string trace_path = argv[1];
+    std::vector<CachePolicyType> policies = {CachePolicyType::LRU, CachePolicyType::WTinyLFU, CachePolicyType::Clock};
+    std::vector<size_t> capacities_mb;
+    std::vector<size_t> max_files_mb = {20};
+    bool charge_memory = true;
+    bool csv = false;
+
+    for (int i = 2; i < argc; i++) {
+        std::string option = argv[i];
+        if (option == "--csv") {
+            csv = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            return usage();
+        }
+        std::string value = argv[++i];
+        bool ok = true;
+        if (option == "--policies") {
+            ok = parsePolicies(value, policies);
+        } else if (option == "--capacities-mb") {
+            ok = parseSizes(value, capacities_mb);
+        } else if (option == "--max-file-mb") {
+            ok = parseSizes(value, max_files_mb);
+        } else if (option == "--charge") {
+            ok = value == "memory" || value == "payload";
+            charge_memory = value == "memory";
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            std::cerr << "Error: invalid value for " << option << ": " << value << std::endl;
+            return usage();
+        }
+    }
+
+    std::ifstream file;
+    if (trace_path != "-") {
+        file.open(trace_path);
+        if (!file) {
+            std::cerr << "Error: cannot open trace " << trace_path << std::endl;
+            return 1;
+        }
+    }
+    size_t skipped = 0;
+    std::vector<TraceRecord> trace = loadTrace(trace_path == "-" ? std::cin : file, &skipped);
+    if (trace.empty()) {
+        std::cerr << "Error: no usable records in " << trace_path << std::endl;
+        return 1;
+    }
+
+    ChargeFunction charge;
+    if (charge_memory) {
+        charge = [](const TraceRecord& record) {
+            return LRUFileCache::estimateCharge(record.key.size(), record.size_bytes);
+        };
+    }
+
+    // Working set: every distinct path at its last seen size
+    std::unordered_map<std::string, size_t> working_set;
+    size_t bytes_requested = 0;
+    for (const auto& record : trace) {
+        working_set[record.key] = charge ? charge(record) : record.size_bytes;
+        bytes_requested += record.size_bytes;
+    }
+    size_t working_set_bytes = 0;
+    for (const auto& entry : working_set) {
+        working_set_bytes += entry.second;
+    }
+
+    if (capacities_mb.empty()) {
+        for (size_t mb = 8; ; mb *= 2) {
+            capacities_mb.push_back(mb);
+            if (mb * 1024 * 1024 >= working_set_bytes || capacities_mb.size() == 16) {
+                break;
+            }
+        }
+    }
+
+    std::cerr << "[CacheSimulator] " << trace.size() << " requests (" << skipped << " lines skipped), "
+              << working_set.size() << " distinct paths, working set "
+              << (working_set_bytes / (1024 * 1024)) << " MB"
+              << (charge_memory ? " charged as cache memory" : "") << ", "
+              << (bytes_requested / (1024 * 1024)) << " MB requested" << std::endl;
+
+    if (csv) {
+        std::cout << "policy,capacity_mb,max_file_mb,requests,hit_ratio,byte_hit_ratio" << std::endl;
+    } else {
+        std::cout << std::left << std::setw(10) << "policy" << std::right
+                  << std::setw(13) << "capacity_mb" << std::setw(13) << "max_file_mb"
+                  << std::setw(11) << "hit_ratio" << std::setw(16) << "byte_hit_ratio" << std::endl;
+    }
+
+    std::cout << std::fixed << std::setprecision(4);
+    for (size_t max_file_mb : max_files_mb) {
+        for (size_t capacity_mb : capacities_mb) {
+            for (CachePolicyType policy : policies) {
+                SimulationResult result = simulateTrace(policy, capacity_mb * 1024 * 1024,
+                                                        max_file_mb * 1024 * 1024, trace, charge);
+                if (csv) {
+                    std::cout << result.policy << "," << capacity_mb << "," << max_file_mb << ","
+                              << result.requests << "," << result.hitRatio() << ","
+                              << result.byteHitRatio() << std::endl;
+                } else {
+                    std::cout << std::left << std::setw(10) << result.policy << std::right
+                              << std::setw(13) << capacity_mb << std::setw(13) << max_file_mb
+                              << std::setw(11) << result.hitRatio()
+                              << std::setw(16) << result.byteHitRatio() << std::endl;
+                }
+            }
+        }
+    }
+    return 0;
+}